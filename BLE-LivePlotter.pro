@@ -9,21 +9,50 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    capturefile.cpp \
+    capturerecorder.cpp \
+    capturewriter.cpp \
     characteristicinfo.cpp \
+    consolesink.cpp \
     device.cpp \
+    devicemanager.cpp \
     deviceinfo.cpp \
+    hexringview.cpp \
+    latencymonitor.cpp \
     main.cpp \
     mainwindow.cpp \
+    packetdecoder.cpp \
     qcustomplot.cpp \
-    serviceinfo.cpp
+    renderscheduler.cpp \
+    replaysource.cpp \
+    rxkernels.cpp \
+    serviceinfo.cpp \
+    simulatedperipheral.cpp \
+    streamingautoscale.cpp
 
 HEADERS += \
+    capturefile.h \
+    captureformat.h \
+    capturerecorder.h \
+    capturewriter.h \
     characteristicinfo.h \
+    consolesink.h \
     device.h \
+    devicemanager.h \
+    devicetransport.h \
     deviceinfo.h \
+    hexringview.h \
+    latencymonitor.h \
     mainwindow.h \
+    packetdecoder.h \
     qcustomplot.h \
-    serviceinfo.h
+    renderscheduler.h \
+    replaysource.h \
+    rxkernels.h \
+    samplering.h \
+    serviceinfo.h \
+    simulatedperipheral.h \
+    streamingautoscale.h
 
 FORMS += \
     mainwindow.ui
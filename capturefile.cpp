@@ -0,0 +1,317 @@
+#include "capturefile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+CaptureFile::~CaptureFile()
+{
+    close();
+}
+
+bool CaptureFile::open(const QString &filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size < qint64(sizeof(CaptureFormat::FileHeader))) {
+        m_error = QStringLiteral("File is too short");
+        close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        m_error = m_file.errorString();
+        close();
+        return false;
+    }
+
+    CaptureFormat::FileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    if (std::memcmp(header.magic, CaptureFormat::Magic, sizeof(header.magic)) != 0) {
+        m_error = QStringLiteral("Not a capture file");
+        close();
+        return false;
+    }
+    if (header.version != CaptureFormat::Version || header.channelCount != CaptureFormat::ChannelCount) {
+        m_error = QStringLiteral("Unsupported capture version %1").arg(header.version);
+        close();
+        return false;
+    }
+
+    // A footer that is not there or cut off means an unfinished recording, the index is
+    // rebuilt. An invalid source id in it does not, the file is damaged
+    m_error.clear();
+    if (!readIndex() && (!m_error.isEmpty() || !rebuildIndex())) {
+        close();
+        return false;
+    }
+
+    // Chunks of one source are written in key order, so the per source lists are sorted
+    m_sourceEntries.assign(size_t(m_sourceNames.size()), {});
+    m_sourceSamples.assign(size_t(m_sourceNames.size()), 0);
+    for (quint64 i = 0; i < m_entryCount; i++) {
+        const CaptureFormat::IndexEntry &e = m_index[i];
+        // The source table of the footer names every source that has chunks
+        if (e.source >= quint32(m_sourceNames.size()) && (hasIndex() || !addSource(e.source, nullptr, 0))) {
+            m_error = QStringLiteral("Invalid source id %1").arg(e.source);
+            close();
+            return false;
+        }
+        m_sourceEntries[e.source].push_back(quint32(i));
+        m_sourceSamples[e.source] += e.sampleCount;
+    }
+    return true;
+}
+
+void CaptureFile::close()
+{
+    if (m_data)
+        m_file.unmap(const_cast<uchar *>(m_data));
+    m_data = nullptr;
+    m_size = 0;
+    m_file.close();
+
+    m_index = nullptr;
+    m_entryCount = 0;
+    m_rebuiltIndex.clear();
+    m_sourceNames.clear();
+    m_sourceEntries.clear();
+    m_sourceSamples.clear();
+}
+
+bool CaptureFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+QString CaptureFile::errorString() const
+{
+    return m_error;
+}
+
+bool CaptureFile::hasIndex() const
+{
+    return isOpen() && m_rebuiltIndex.empty() && m_index != nullptr;
+}
+
+bool CaptureFile::readIndex()
+{
+    if (m_size < qint64(sizeof(CaptureFormat::FileHeader) + sizeof(CaptureFormat::Footer)))
+        return false;
+
+    CaptureFormat::Footer footer;
+    std::memcpy(&footer, m_data + m_size - sizeof(footer), sizeof(footer));
+    if (footer.magic != CaptureFormat::FooterMagic)
+        return false;
+
+    const quint64 indexEnd = quint64(m_size) - sizeof(footer);
+    if (footer.indexOffset > indexEnd || footer.sourceTableOffset > footer.indexOffset
+            || footer.entryCount > (indexEnd - footer.indexOffset)/sizeof(CaptureFormat::IndexEntry))
+        return false;
+    if (footer.sourceCount > CaptureFormat::MaxSources) {
+        m_error = QStringLiteral("Invalid source count %1").arg(footer.sourceCount);
+        return false;
+    }
+
+    // Source table
+    quint64 pos = footer.sourceTableOffset;
+    for (quint32 i = 0; i < footer.sourceCount; i++) {
+        if (pos + sizeof(CaptureFormat::SourceRecord) > footer.indexOffset)
+            return false;
+        CaptureFormat::SourceRecord record;
+        std::memcpy(&record, m_data + pos, sizeof(record));
+        pos += sizeof(record);
+        if (record.magic != CaptureFormat::SourceMagic || pos + record.nameLength > footer.indexOffset)
+            return false;
+        if (record.source >= footer.sourceCount) {
+            m_error = QStringLiteral("Invalid source id %1").arg(record.source);
+            return false;
+        }
+        addSource(record.source, reinterpret_cast<const char *>(m_data + pos), record.nameLength);
+        pos += quint64(CaptureFormat::padded(record.nameLength));
+    }
+
+    // The index is used in place, the writer keeps it 8 byte aligned
+    m_index = reinterpret_cast<const CaptureFormat::IndexEntry *>(m_data + footer.indexOffset);
+    m_entryCount = footer.entryCount;
+    return true;
+}
+
+bool CaptureFile::rebuildIndex()
+{
+    m_sourceNames.clear();
+    m_rebuiltIndex.clear();
+
+    // Walk the records until the end or the first incomplete one
+    quint64 pos = sizeof(CaptureFormat::FileHeader);
+    const quint64 size = quint64(m_size);
+    while (pos + sizeof(quint32) <= size) {
+        quint32 magic;
+        std::memcpy(&magic, m_data + pos, sizeof(magic));
+
+        if (magic == CaptureFormat::SourceMagic && pos + sizeof(CaptureFormat::SourceRecord) <= size) {
+            CaptureFormat::SourceRecord record;
+            std::memcpy(&record, m_data + pos, sizeof(record));
+            const quint64 next = pos + sizeof(record) + quint64(CaptureFormat::padded(record.nameLength));
+            if (next > size)
+                break;
+            if (!addSource(record.source, reinterpret_cast<const char *>(m_data + pos + sizeof(record)), record.nameLength)) {
+                m_error = QStringLiteral("Invalid source id %1").arg(record.source);
+                return false;
+            }
+            pos = next;
+        } else if (magic == CaptureFormat::ChunkMagic && pos + sizeof(CaptureFormat::ChunkHeader) <= size) {
+            CaptureFormat::ChunkHeader header;
+            std::memcpy(&header, m_data + pos, sizeof(header));
+            const quint64 next = pos + sizeof(header) + quint64(header.sampleCount)*sizeof(RxSample);
+            if (header.sampleCount == 0 || next > size)
+                break;
+
+            CaptureFormat::IndexEntry entry;
+            entry.offset = pos;
+            entry.source = header.source;
+            entry.sampleCount = header.sampleCount;
+            entry.firstKey = header.firstKey;
+            entry.lastKey = header.lastKey;
+            m_rebuiltIndex.push_back(entry);
+            pos = next;
+        } else {
+            break;
+        }
+    }
+
+    m_index = m_rebuiltIndex.data();
+    m_entryCount = m_rebuiltIndex.size();
+    return true;
+}
+
+bool CaptureFile::addSource(quint32 source, const char *name, quint32 nameLength)
+{
+    // Source ids are indices into the per source tables, a damaged id must not size them
+    if (source >= CaptureFormat::MaxSources)
+        return false;
+
+    while (quint32(m_sourceNames.size()) <= source)
+        m_sourceNames.append(QStringLiteral("Source %1").arg(m_sourceNames.size() + 1));
+    if (name)
+        m_sourceNames[int(source)] = QString::fromUtf8(name, int(nameLength));
+    if (m_sourceEntries.size() < size_t(m_sourceNames.size())) {
+        m_sourceEntries.resize(size_t(m_sourceNames.size()));
+        m_sourceSamples.resize(size_t(m_sourceNames.size()), 0);
+    }
+    return true;
+}
+
+int CaptureFile::sourceCount() const
+{
+    return m_sourceNames.size();
+}
+
+QString CaptureFile::sourceName(int source) const
+{
+    return m_sourceNames.value(source);
+}
+
+QStringList CaptureFile::sourceNames() const
+{
+    return m_sourceNames;
+}
+
+int CaptureFile::chunkCount(int source) const
+{
+    if (source < 0 || source >= int(m_sourceEntries.size()))
+        return 0;
+    return int(m_sourceEntries[size_t(source)].size());
+}
+
+const CaptureFormat::IndexEntry &CaptureFile::entry(int source, int index) const
+{
+    return m_index[m_sourceEntries[size_t(source)][size_t(index)]];
+}
+
+CaptureFile::Chunk CaptureFile::chunk(int source, int index) const
+{
+    Chunk c;
+    if (index < 0 || index >= chunkCount(source))
+        return c;
+
+    const CaptureFormat::IndexEntry &e = entry(source, index);
+    if (e.offset + sizeof(CaptureFormat::ChunkHeader) + quint64(e.sampleCount)*sizeof(RxSample) > quint64(m_size))
+        return c;
+
+    c.header = reinterpret_cast<const CaptureFormat::ChunkHeader *>(m_data + e.offset);
+    c.samples = reinterpret_cast<const RxSample *>(m_data + e.offset + sizeof(CaptureFormat::ChunkHeader));
+    c.sampleCount = int(e.sampleCount);
+    return c;
+}
+
+int CaptureFile::findChunk(int source, double key) const
+{
+    if (source < 0 || source >= int(m_sourceEntries.size()))
+        return 0;
+
+    const std::vector<quint32> &entries = m_sourceEntries[size_t(source)];
+    const auto it = std::lower_bound(entries.begin(), entries.end(), key, [this](quint32 i, double k) {
+        return m_index[i].lastKey < k;
+    });
+    return int(it - entries.begin());
+}
+
+quint64 CaptureFile::sampleCount(int source) const
+{
+    if (source < 0 || source >= int(m_sourceSamples.size()))
+        return 0;
+    return m_sourceSamples[size_t(source)];
+}
+
+double CaptureFile::firstKey(int source) const
+{
+    if (chunkCount(source) == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    return entry(source, 0).firstKey;
+}
+
+double CaptureFile::lastKey(int source) const
+{
+    const int n = chunkCount(source);
+    if (n == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    return entry(source, n - 1).lastKey;
+}
+
+QVector<RxSample> CaptureFile::samples(int source, double from, double to) const
+{
+    QVector<RxSample> result;
+    const int n = chunkCount(source);
+    for (int i = findChunk(source, from); i < n; i++) {
+        const Chunk c = chunk(source, i);
+        if (!c.header || c.header->firstKey > to)
+            break;
+
+        const RxSample *begin = std::lower_bound(c.samples, c.samples + c.sampleCount, from,
+                                                 [](const RxSample &s, double k) { return s.key < k; });
+        const RxSample *end = std::upper_bound(begin, c.samples + c.sampleCount, to,
+                                               [](double k, const RxSample &s) { return k < s.key; });
+        for (const RxSample *s = begin; s != end; ++s)
+            result.append(*s);
+    }
+    return result;
+}
+
+bool CaptureFile::isCaptureFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray magic = file.read(sizeof(CaptureFormat::Magic));
+    return magic.size() == int(sizeof(CaptureFormat::Magic))
+            && std::memcmp(magic.constData(), CaptureFormat::Magic, sizeof(CaptureFormat::Magic)) == 0;
+}
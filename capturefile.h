@@ -0,0 +1,79 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+#include "captureformat.h"
+
+// Read-only view of a capture file written by the CaptureWriter.
+// The file is memory-mapped, chunks and samples are used in place and only
+// the pages that are actually read are loaded. Seeking by time is a binary
+// search over the chunk index of a source, so it does not depend on the
+// length of the recording. Files without index (the recording was not
+// stopped cleanly) are indexed once on open by walking the chunk headers.
+class CaptureFile
+{
+public:
+    struct Chunk
+    {
+        const CaptureFormat::ChunkHeader *header = nullptr;
+        const RxSample *samples = nullptr;
+        int sampleCount = 0;
+    };
+
+    CaptureFile() = default;
+    ~CaptureFile();
+
+    bool open(const QString &filePath);
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+    // False if the index had to be rebuilt
+    bool hasIndex() const;
+
+    int sourceCount() const;
+    QString sourceName(int source) const;
+    QStringList sourceNames() const;
+
+    int chunkCount(int source) const;
+    Chunk chunk(int source, int index) const;
+    // First chunk of the source whose key range ends at or after key,
+    // chunkCount(source) if the source ends before key
+    int findChunk(int source, double key) const;
+
+    quint64 sampleCount(int source) const;
+    double firstKey(int source) const;
+    double lastKey(int source) const;
+
+    // Copies the samples with from <= key <= to
+    QVector<RxSample> samples(int source, double from, double to) const;
+
+    // True if the file starts with the CaptureFormat magic
+    static bool isCaptureFile(const QString &filePath);
+
+private:
+    bool readIndex();
+    bool rebuildIndex();
+    bool addSource(quint32 source, const char *name, quint32 nameLength);
+    const CaptureFormat::IndexEntry &entry(int source, int index) const;
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    QString m_error;
+
+    // Points into the mapped file, or into m_rebuiltIndex
+    const CaptureFormat::IndexEntry *m_index = nullptr;
+    quint64 m_entryCount = 0;
+    std::vector<CaptureFormat::IndexEntry> m_rebuiltIndex;
+
+    QStringList m_sourceNames;
+    // Index entries of each source, in key order
+    std::vector<std::vector<quint32>> m_sourceEntries;
+    std::vector<quint64> m_sourceSamples;
+};
+
+#endif // CAPTUREFILE_H
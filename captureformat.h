@@ -0,0 +1,88 @@
+#ifndef CAPTUREFORMAT_H
+#define CAPTUREFORMAT_H
+
+#include <QtGlobal>
+#include "samplering.h"
+
+// On-disk layout of a capture (.acc) written by the CaptureWriter.
+// All values are in host byte order (little endian on all supported targets)
+// and every record is 8 byte aligned, so the file can be memory-mapped and
+// the samples used in place.
+//
+//   FileHeader
+//   { SourceRecord + name | ChunkHeader + sampleCount * RxSample } ...
+//   SourceRecord + name ...           (source table, written on close)
+//   IndexEntry ...                    (one per chunk, in file order)
+//   Footer
+//
+// A file without footer (e.g. after a crash) is still readable, the reader
+// then rebuilds the index by walking the chunk headers.
+namespace CaptureFormat
+{
+    static const char Magic[8] = { 'B', 'L', 'E', 'C', 'A', 'P', '\r', '\n' };
+    static const quint32 Version = 2;
+    static const quint32 SourceMagic = 0x45435253; // "SRCE"
+    static const quint32 ChunkMagic = 0x4B4E4843;  // "CHNK"
+    static const quint32 FooterMagic = 0x58444E49; // "INDX"
+    static const int ChannelCount = 3;
+    // Source ids are small indices, a reader rejects files with larger ones
+    static const quint32 MaxSources = 256;
+
+    struct FileHeader
+    {
+        char magic[8];
+        quint32 version;
+        quint32 channelCount;
+    };
+
+    // Names a source (device), the UTF-8 name follows, padded to 8 bytes
+    struct SourceRecord
+    {
+        quint32 magic;
+        quint32 source;
+        quint32 nameLength;
+        quint32 reserved;
+    };
+
+    // A run of samples of one source, sorted by key, with its value summary
+    struct ChunkHeader
+    {
+        quint32 magic;
+        quint32 source;
+        quint32 sampleCount;
+        quint32 reserved;
+        double firstKey;
+        double lastKey;
+        double minValue[ChannelCount];
+        double maxValue[ChannelCount];
+    };
+
+    struct IndexEntry
+    {
+        quint64 offset; // of the ChunkHeader
+        quint32 source;
+        quint32 sampleCount;
+        double firstKey;
+        double lastKey;
+    };
+
+    struct Footer
+    {
+        quint32 magic;
+        quint32 sourceCount;
+        quint64 sourceTableOffset;
+        quint64 indexOffset;
+        quint64 entryCount;
+    };
+
+    inline qint64 padded(qint64 size) { return (size + 7) & ~qint64(7); }
+
+    static_assert(sizeof(FileHeader) == 16, "unexpected FileHeader padding");
+    static_assert(sizeof(SourceRecord) == 16, "unexpected SourceRecord padding");
+    static_assert(sizeof(ChunkHeader) == 80, "unexpected ChunkHeader padding");
+    static_assert(sizeof(IndexEntry) == 32, "unexpected IndexEntry padding");
+    static_assert(sizeof(Footer) == 32, "unexpected Footer padding");
+    static_assert(sizeof(RxSample) == 32, "unexpected RxSample padding");
+}
+
+#endif // CAPTUREFORMAT_H
@@ -0,0 +1,204 @@
+#include "capturerecorder.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+CaptureRecorder::CaptureRecorder()
+{
+}
+
+CaptureRecorder::~CaptureRecorder()
+{
+    stop();
+}
+
+int CaptureRecorder::addSource(const QString &name)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_sources.size() >= CaptureFormat::MaxSources)
+        return -1;
+
+    // Both buffers are allocated once, the writer only swaps them
+    SourceBuffer buffer;
+    buffer.name = name;
+    buffer.front.reserve(MaxBufferedSamples);
+    buffer.back.reserve(MaxBufferedSamples);
+    m_sources.push_back(std::move(buffer));
+    return int(m_sources.size()) - 1;
+}
+
+QStringList CaptureRecorder::sourceNames() const
+{
+    QMutexLocker lock(&m_mutex);
+    QStringList names;
+    for (const SourceBuffer &s : m_sources)
+        names.append(s.name);
+    return names;
+}
+
+bool CaptureRecorder::start(const QString &filePath)
+{
+    stop();
+
+    if (!m_output.open(filePath)) {
+        QMutexLocker lock(&m_mutex);
+        m_error = m_output.errorString();
+        return false;
+    }
+
+    m_filePath = filePath;
+    m_bytesWritten = m_output.bytesWritten();
+    m_samplesWritten = 0;
+    m_samplesDropped = 0;
+    {
+        QMutexLocker lock(&m_mutex);
+        for (SourceBuffer &s : m_sources)
+            s.front.clear();
+        m_sourcesNamed = 0;
+        m_stopRequested = false;
+        m_error.clear();
+    }
+
+    m_recording = true;
+    m_writer = QThread::create([this] { writerLoop(); });
+    m_writer->start();
+    return true;
+}
+
+void CaptureRecorder::stop()
+{
+    if (!m_writer)
+        return;
+
+    m_recording = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stopRequested = true;
+        m_wake.wakeAll();
+    }
+    m_writer->wait();
+    delete m_writer;
+    m_writer = nullptr;
+
+    // Appends the source table and the chunk index
+    const bool closed = m_output.close();
+    m_bytesWritten = m_output.bytesWritten();
+    QMutexLocker lock(&m_mutex);
+    if (!closed && m_error.isEmpty())
+        m_error = m_output.errorString();
+}
+
+bool CaptureRecorder::isRecording() const
+{
+    return m_recording;
+}
+
+QString CaptureRecorder::filePath() const
+{
+    return m_filePath;
+}
+
+QString CaptureRecorder::errorString() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_error;
+}
+
+void CaptureRecorder::append(int source, const RxSample *samples, int count)
+{
+    if (!m_recording || count <= 0)
+        return;
+
+    QMutexLocker lock(&m_mutex);
+    if (source < 0 || source >= int(m_sources.size()))
+        return;
+
+    // Never grow past the preallocated buffer
+    std::vector<RxSample> &front = m_sources[size_t(source)].front;
+    const int room = int(front.capacity() - front.size());
+    const int n = qMin(count, room);
+    front.insert(front.end(), samples, samples + n);
+    if (n < count)
+        m_samplesDropped += quint64(count - n);
+
+    // Wake the writer early if a buffer is getting full
+    if (int(front.size()) >= MaxBufferedSamples/2)
+        m_wake.wakeOne();
+}
+
+void CaptureRecorder::writerLoop()
+{
+    QElapsedTimer sinceSync;
+    sinceSync.start();
+
+    QMutexLocker lock(&m_mutex);
+    bool stopping = false;
+    while (!stopping) {
+        if (!m_stopRequested)
+            m_wake.wait(&m_mutex, FlushInterval);
+        stopping = m_stopRequested;
+
+        // Swap under the lock, write without it
+        for (SourceBuffer &s : m_sources)
+            s.front.swap(s.back);
+
+        QStringList newNames;
+        for (size_t i = size_t(m_sourcesNamed); i < m_sources.size(); i++)
+            newNames.append(m_sources[i].name);
+        const int firstNew = m_sourcesNamed;
+        m_sourcesNamed = int(m_sources.size());
+
+        // addSource() may grow the deque while the lock is released. The elements stay
+        // in place, but indexing the deque would race with it, so take the pointers now
+        std::vector<SourceBuffer *> sources;
+        sources.reserve(m_sources.size());
+        for (SourceBuffer &s : m_sources)
+            sources.push_back(&s);
+        lock.unlock();
+
+        bool ok = true;
+        for (int i = 0; ok && i < newNames.size(); i++)
+            ok = m_output.writeSource(firstNew + i, newNames.at(i));
+
+        for (size_t i = 0; i < sources.size(); i++) {
+            std::vector<RxSample> &back = sources[i]->back;
+            if (ok && !back.empty()) {
+                ok = m_output.writeSamples(int(i), back.data(), int(back.size()));
+                if (ok)
+                    m_samplesWritten += back.size();
+                else
+                    m_samplesDropped += back.size();
+            }
+            back.clear();
+        }
+        m_bytesWritten = m_output.bytesWritten();
+
+        if (ok && sinceSync.elapsed() >= SyncInterval) {
+            ok = m_output.sync();
+            sinceSync.restart();
+        }
+        lock.relock();
+
+        // Stop on the first failed write, the producers stop appending
+        if (!ok) {
+            m_error = m_output.errorString();
+            m_recording = false;
+            stopping = true;
+        }
+    }
+}
+
+quint64 CaptureRecorder::samplesWritten() const
+{
+    return m_samplesWritten;
+}
+
+quint64 CaptureRecorder::samplesDropped() const
+{
+    return m_samplesDropped;
+}
+
+quint64 CaptureRecorder::bytesWritten() const
+{
+    return m_bytesWritten;
+}
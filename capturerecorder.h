@@ -0,0 +1,83 @@
+#ifndef CAPTURERECORDER_H
+#define CAPTURERECORDER_H
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include "capturewriter.h"
+#include "samplering.h"
+
+class QThread;
+
+// Writes every decoded sample to disk while the capture runs.
+// Producers (the devices) append into a preallocated front buffer per source,
+// a writer thread swaps it with the back buffer and writes the back buffer as
+// chunks, so the producers never wait for the disk. The buffers never grow:
+// samples that arrive while a front buffer is full are dropped and counted.
+// The file is fsynced periodically, so a crash loses at most a few seconds,
+// the chunk index is appended when the recording is stopped. If a write fails
+// the recording ends by itself, isRecording() turns false and errorString()
+// tells why, the owner still calls stop().
+class CaptureRecorder
+{
+public:
+    CaptureRecorder();
+    ~CaptureRecorder();
+
+    // Returns the source id, or -1 past CaptureFormat::MaxSources.
+    // Sources may also be added while recording
+    int addSource(const QString &name);
+    QStringList sourceNames() const;
+
+    bool start(const QString &filePath);
+    void stop();
+    bool isRecording() const;
+    QString filePath() const;
+    // Empty unless writing failed during the last recording
+    QString errorString() const;
+
+    // Thread safe, called by the producers
+    void append(int source, const RxSample *samples, int count);
+
+    quint64 samplesWritten() const;
+    quint64 samplesDropped() const;
+    quint64 bytesWritten() const;
+
+    // Tuning, samples per front buffer, intervals in ms
+    static const int MaxBufferedSamples = 65536;
+    static const int FlushInterval = 100;
+    static const int SyncInterval = 2000;
+
+private:
+    struct SourceBuffer
+    {
+        QString name;
+        std::vector<RxSample> front;
+        std::vector<RxSample> back;
+    };
+
+    void writerLoop();
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    // A deque keeps the buffers in place when sources are added during a recording
+    std::deque<SourceBuffer> m_sources;
+    int m_sourcesNamed = 0;
+    bool m_stopRequested = false;
+
+    CaptureWriter m_output;
+    QString m_filePath;
+    QString m_error;
+    QThread *m_writer = nullptr;
+    std::atomic<bool> m_recording{false};
+
+    std::atomic<quint64> m_samplesWritten{0};
+    std::atomic<quint64> m_samplesDropped{0};
+    std::atomic<quint64> m_bytesWritten{0};
+};
+
+#endif // CAPTURERECORDER_H
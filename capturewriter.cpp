@@ -0,0 +1,191 @@
+#include "capturewriter.h"
+
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+bool CaptureWriter::open(const QString &filePath)
+{
+    close();
+
+    m_error.clear();
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    CaptureFormat::FileHeader header;
+    std::memcpy(header.magic, CaptureFormat::Magic, sizeof(header.magic));
+    header.version = CaptureFormat::Version;
+    header.channelCount = CaptureFormat::ChannelCount;
+
+    if (!write(reinterpret_cast<const char *>(&header), sizeof(header))) {
+        m_file.close();
+        return false;
+    }
+
+    m_sources.clear();
+    m_index.clear();
+    m_bytesWritten = sizeof(header);
+    return true;
+}
+
+bool CaptureWriter::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+QString CaptureWriter::fileName() const
+{
+    return m_file.fileName();
+}
+
+QString CaptureWriter::errorString() const
+{
+    return m_error;
+}
+
+bool CaptureWriter::write(const char *data, qint64 size)
+{
+    // After the first failure nothing more is written, a reader stops at the incomplete record
+    if (!m_error.isEmpty())
+        return false;
+    if (m_file.write(data, size) != size) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_bytesWritten += quint64(size);
+    return true;
+}
+
+bool CaptureWriter::writeSource(int source, const QString &name)
+{
+    m_sources.append(qMakePair(source, name));
+    return writeSourceRecord(source, name);
+}
+
+bool CaptureWriter::writeSourceRecord(int source, const QString &name)
+{
+    const QByteArray utf8 = name.toUtf8();
+
+    CaptureFormat::SourceRecord record;
+    record.magic = CaptureFormat::SourceMagic;
+    record.source = quint32(source);
+    record.nameLength = quint32(utf8.size());
+    record.reserved = 0;
+
+    QByteArray padded = utf8;
+    padded.append(QByteArray(int(CaptureFormat::padded(utf8.size()) - utf8.size()), '\0'));
+
+    return write(reinterpret_cast<const char *>(&record), sizeof(record))
+            && write(padded.constData(), padded.size());
+}
+
+bool CaptureWriter::writeSamples(int source, const RxSample *samples, int count)
+{
+    for (int offset = 0; offset < count; offset += ChunkSamples) {
+        const int n = qMin(count - offset, int(ChunkSamples));
+        const RxSample *chunk = samples + offset;
+
+        CaptureFormat::ChunkHeader header;
+        header.magic = CaptureFormat::ChunkMagic;
+        header.source = quint32(source);
+        header.sampleCount = quint32(n);
+        header.reserved = 0;
+        header.firstKey = chunk[0].key;
+        header.lastKey = chunk[n - 1].key;
+
+        // Value summary, lets a reader draw or scale a chunk without touching its samples
+        header.minValue[0] = header.maxValue[0] = chunk[0].x;
+        header.minValue[1] = header.maxValue[1] = chunk[0].y;
+        header.minValue[2] = header.maxValue[2] = chunk[0].z;
+        for (int i = 1; i < n; i++) {
+            header.minValue[0] = qMin(header.minValue[0], chunk[i].x);
+            header.maxValue[0] = qMax(header.maxValue[0], chunk[i].x);
+            header.minValue[1] = qMin(header.minValue[1], chunk[i].y);
+            header.maxValue[1] = qMax(header.maxValue[1], chunk[i].y);
+            header.minValue[2] = qMin(header.minValue[2], chunk[i].z);
+            header.maxValue[2] = qMax(header.maxValue[2], chunk[i].z);
+        }
+
+        CaptureFormat::IndexEntry entry;
+        entry.offset = quint64(m_file.pos());
+        entry.source = header.source;
+        entry.sampleCount = header.sampleCount;
+        entry.firstKey = header.firstKey;
+        entry.lastKey = header.lastKey;
+        m_index.push_back(entry);
+
+        // A chunk that was not written completely must not be in the index
+        const qint64 dataSize = qint64(n)*qint64(sizeof(RxSample));
+        if (!write(reinterpret_cast<const char *>(&header), sizeof(header))
+                || !write(reinterpret_cast<const char *>(chunk), dataSize)) {
+            m_index.pop_back();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CaptureWriter::sync()
+{
+    if (!m_file.isOpen())
+        return false;
+
+    // Push Qt's buffer to the OS, then the OS cache to the disk
+    if (!m_file.flush()) {
+        if (m_error.isEmpty())
+            m_error = m_file.errorString();
+        return false;
+    }
+#if defined(Q_OS_WIN)
+    const bool synced = _commit(m_file.handle()) == 0;
+#else
+    const bool synced = ::fsync(m_file.handle()) == 0;
+#endif
+    if (!synced && m_error.isEmpty())
+        m_error = QStringLiteral("Failed to sync %1 to the disk").arg(m_file.fileName());
+    return synced && m_error.isEmpty();
+}
+
+bool CaptureWriter::close()
+{
+    if (!m_file.isOpen())
+        return m_error.isEmpty();
+
+    CaptureFormat::Footer footer;
+    footer.magic = CaptureFormat::FooterMagic;
+    footer.sourceCount = quint32(m_sources.size());
+
+    // Source table, so a reader does not have to look for the names between the chunks
+    footer.sourceTableOffset = quint64(m_file.pos());
+    for (const auto &source : std::as_const(m_sources))
+        writeSourceRecord(source.first, source.second);
+
+    footer.indexOffset = quint64(m_file.pos());
+    footer.entryCount = quint64(m_index.size());
+    const qint64 indexSize = qint64(m_index.size()*sizeof(CaptureFormat::IndexEntry));
+    write(reinterpret_cast<const char *>(m_index.data()), indexSize);
+    write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+
+    // Without a complete footer the reader rebuilds the index from the chunks
+    const bool ok = sync();
+    m_file.close();
+    m_index.clear();
+    return ok;
+}
+
+quint64 CaptureWriter::bytesWritten() const
+{
+    return m_bytesWritten;
+}
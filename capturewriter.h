@@ -0,0 +1,50 @@
+#ifndef CAPTUREWRITER_H
+#define CAPTUREWRITER_H
+
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <vector>
+#include "captureformat.h"
+
+// Writes a capture file in the CaptureFormat layout. Samples are written as
+// chunks with their key range and min/max per channel; close() appends the
+// source table and the chunk index. Not thread safe, use it from one thread.
+// The write functions return false once a write failed (e.g. the disk is
+// full), errorString() then tells why and the file should be closed.
+class CaptureWriter
+{
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    bool open(const QString &filePath);
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+
+    bool writeSource(int source, const QString &name);
+    // Splits the samples into chunks of at most ChunkSamples
+    bool writeSamples(int source, const RxSample *samples, int count);
+
+    // Flushes Qt's and the OS buffers to the disk
+    bool sync();
+    bool close();
+
+    quint64 bytesWritten() const;
+
+    static const int ChunkSamples = 4096;
+
+private:
+    bool writeSourceRecord(int source, const QString &name);
+    bool write(const char *data, qint64 size);
+
+    QFile m_file;
+    QString m_error;
+    QList<QPair<int, QString>> m_sources;
+    std::vector<CaptureFormat::IndexEntry> m_index;
+    quint64 m_bytesWritten = 0;
+};
+
+#endif // CAPTUREWRITER_H
@@ -0,0 +1,83 @@
+#include "consolesink.h"
+
+#include <QPlainTextEdit>
+
+ConsoleSink::ConsoleSink(QPlainTextEdit *console, QObject *parent)
+    : QObject(parent)
+    , m_console(console)
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(DefaultFlushInterval);
+    connect(&m_flushTimer, &QTimer::timeout, this, &ConsoleSink::flush);
+    m_console->setMaximumBlockCount(m_maximumLines);
+}
+
+void ConsoleSink::setFlushInterval(int ms)
+{
+    m_flushTimer.setInterval(qMax(0, ms));
+}
+
+int ConsoleSink::flushInterval() const
+{
+    return m_flushTimer.interval();
+}
+
+void ConsoleSink::setMaximumLines(int lines)
+{
+    m_maximumLines = qMax(1, lines);
+    m_console->setMaximumBlockCount(m_maximumLines);
+}
+
+int ConsoleSink::maximumLines() const
+{
+    return m_maximumLines;
+}
+
+quint64 ConsoleSink::linesWritten() const
+{
+    return m_linesWritten;
+}
+
+quint64 ConsoleSink::linesDropped() const
+{
+    return m_linesDropped;
+}
+
+void ConsoleSink::append(const QString &line)
+{
+    // Lines the widget would trim right away are not worth keeping
+    if (m_pending.size() >= m_maximumLines) {
+        m_pending.removeFirst();
+        m_droppedPending++;
+        m_linesDropped++;
+    }
+    m_pending.append(line);
+
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void ConsoleSink::flush()
+{
+    m_flushTimer.stop();
+    if (m_pending.isEmpty())
+        return;
+
+    m_linesWritten += quint64(m_pending.size());
+    if (m_droppedPending > 0)
+        m_pending.prepend(QString("... %1 lines dropped").arg(m_droppedPending));
+
+    // One layout pass for the whole batch instead of one per line
+    m_console->appendPlainText(m_pending.join('\n'));
+
+    m_pending.clear();
+    m_droppedPending = 0;
+}
+
+void ConsoleSink::clear()
+{
+    m_flushTimer.stop();
+    m_pending.clear();
+    m_droppedPending = 0;
+    m_console->clear();
+}
@@ -0,0 +1,49 @@
+#ifndef CONSOLESINK_H
+#define CONSOLESINK_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+class QPlainTextEdit;
+
+// Batches console lines and writes them to a QPlainTextEdit once per flush
+// interval. The widget keeps at most maximumLines() lines, older ones are
+// trimmed by the document (QPlainTextEdit::setMaximumBlockCount). Lines that
+// pile up faster than the widget could show them are dropped before they reach
+// it, and a single note reports how many were dropped. Lives on the GUI thread.
+class ConsoleSink: public QObject
+{
+    Q_OBJECT
+
+public:
+    ConsoleSink(QPlainTextEdit *console, QObject *parent = nullptr);
+
+    void setFlushInterval(int ms);
+    int flushInterval() const;
+    void setMaximumLines(int lines);
+    int maximumLines() const;
+
+    quint64 linesWritten() const;
+    quint64 linesDropped() const;
+
+    static const int DefaultFlushInterval = 100;
+    static const int DefaultMaximumLines = 2000;
+
+public slots:
+    void append(const QString &line);
+    void flush();
+    void clear();
+
+private:
+    QPlainTextEdit *m_console;
+    QTimer m_flushTimer;
+    QStringList m_pending;
+    int m_maximumLines = DefaultMaximumLines;
+    int m_droppedPending = 0;
+
+    quint64 m_linesWritten = 0;
+    quint64 m_linesDropped = 0;
+};
+
+#endif // CONSOLESINK_H
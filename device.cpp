@@ -9,11 +9,24 @@
 #include <QList>
 #include <QMetaEnum>
 #include <QTimer>
+#include <limits>
+
+// Longest gap between two packets in seconds over which sample keys are interpolated
+static const double MaxInterpolationGap = 0.5;
+// Share of the arrival delay the reconstructed time base follows per packet
+static const double AnchorTracking = 0.001;
+// Largest step of the time anchor towards earlier packets, in sample periods
+static const double MaxAnchorStep = 0.5;
+// Largest forward step of the packet counter that is taken as lost packets, larger
+// steps are packets that arrived late
+static const int MaxSequenceStep = 128;
 
 Device::Device()
 {
+    m_timeBase.start();
 
-    discoveryAgent = new QBluetoothDeviceDiscoveryAgent();
+    // Parent the agent so it follows the Device onto the acquisition thread
+    discoveryAgent = new QBluetoothDeviceDiscoveryAgent(this);
     discoveryAgent->setLowEnergyDiscoveryTimeout(10000);
     connect(discoveryAgent, &QBluetoothDeviceDiscoveryAgent::deviceDiscovered,
             this, &Device::addDevice);
@@ -327,14 +340,300 @@ void Device::connectToRXCharacteristic(const QString &uuid)
     currentService->writeDescriptor(cccd, QLowEnergyCharacteristic::CCCDEnableNotification);
 
     // set up Data transmition when characteristic is changed
-    connect(currentService,&QLowEnergyService::characteristicChanged,this,&Device::updateRXValue);
+    connect(currentService,&QLowEnergyService::characteristicChanged,this,&Device::updateRXValue,Qt::UniqueConnection);
+    setRXCharacteristicName(uuid);
+    m_lastSequence = -1;
 
 }
 
 void Device::updateRXValue(const QLowEnergyCharacteristic &c, const QByteArray &value)
+{
+    Q_UNUSED(c);
+    this->receiveRXValue(value);
+}
+
+void Device::receiveRXValue(const QByteArray &value)
 {
     //qDebug() << value;
-    emit sendRXValue(value);
+    const double arrival = m_timeBase.nsecsElapsed()*1e-9;
+    m_rxBytes += value.length();
+    m_rxNotifications++;
+
+    if(m_decodeRX)
+    {
+        this->decodeRXValue(value,arrival);
+    }
+    else
+    {
+        emit sendRXValue(value);
+    }
+}
+
+void Device::decodeRXValue(const QByteArray &value, double arrival)
+{
+    const PacketDecoder *decoder = m_decoder;
+    const int frames = decoder->frameCount(value.length());
+
+    // Either take every frame of the packet or only the first one
+    int maxSamples = 1;
+    if(m_batchDecoding)
+    {
+        maxSamples = qMax(frames,1);
+    }
+    // The first slot is kept free for a gap marker
+    if(int(m_decodeBuffer.size())<maxSamples+1)
+    {
+        m_decodeBuffer.resize(maxSamples+1);
+    }
+    RxSample *samples = m_decodeBuffer.data()+1;
+
+    //Only accept Data in the correct format
+    int count = decoder->decode(value,samples,maxSamples);
+    if(count<=0)
+    {
+        m_decodeFailures++;
+        return;
+    }
+
+    int missing = 0;
+    if(m_sequenceChecking)
+    {
+        missing = this->checkSequence(decoder->sequenceNumber(value));
+        if(missing<0)
+        {
+            // Its place in the timeline is already taken, or marked as a gap
+            return;
+        }
+    }
+
+    LatencyStamp stamp;
+    stamp.arrival = arrival;
+    stamp.decoded = m_timeBase.nsecsElapsed()*1e-9;
+
+    const double rate = m_nominalSampleRate;
+    if(rate>0)
+    {
+        this->reconstructKeys(samples,count,frames,missing,arrival,rate);
+    }
+    else
+    {
+        // Spread the samples of the packet evenly since the previous packet, the last one
+        // gets the arrival time. After a pause they all get the arrival time.
+        double previous = m_lastArrival;
+        if(previous<0 || arrival-previous>MaxInterpolationGap)
+        {
+            previous = arrival;
+        }
+        for(int i=0;i<count;i++)
+        {
+            samples[i].key = previous+(arrival-previous)*(i+1)/count;
+        }
+    }
+    m_lastArrival = arrival;
+    m_rxSamples += count;
+
+    // Keys never go back, even when the time anchor was reset. The ring, the recorder,
+    // the capture file and the graphs rely on ascending keys.
+    for(int i=0;i<count;i++)
+    {
+        samples[i].key = qMax(samples[i].key,m_lastKey);
+    }
+
+    // The recorder keeps every sample, even if the plot falls behind
+    if(m_recorder)
+    {
+        m_recorder->append(m_recordSource,samples,count);
+    }
+
+    // Lost notifications break the graph line, NaN values are not connected by QCustomPlot
+    int pushCount = count;
+    if(missing>0)
+    {
+        RxSample &gap = m_decodeBuffer[0];
+        gap.key = (m_lastKey+samples[0].key)/2;
+        gap.x = gap.y = gap.z = std::numeric_limits<double>::quiet_NaN();
+        samples--;
+        pushCount++;
+    }
+    m_lastKey = samples[pushCount-1].key;
+
+    // The whole packet goes into the ring at once. If the plot falls behind
+    // the samples that do not fit are dropped and counted as overruns
+    rxRing.push(samples,pushCount);
+
+    stamp.buffered = m_timeBase.nsecsElapsed()*1e-9;
+    m_latencyRing.push(stamp);
+}
+
+void Device::reconstructKeys(RxSample *samples, int count, int frames, int missing, double arrival, double rate)
+{
+    frames = qMax(frames,count);
+    if(rate!=m_appliedSampleRate)
+    {
+        m_appliedSampleRate = rate;
+        m_timeAnchorValid = false;
+    }
+
+    // The frames of lost notifications still took their sample periods
+    m_sampleIndex += quint64(missing)*quint64(frames);
+
+    // Time of sample 0 if the last frame of this packet was sampled at its arrival.
+    // Delays only make it later, so the anchor follows the earliest packets and
+    // creeps up slowly to follow a peripheral clock that runs slower than nominal.
+    const double offset = arrival-double(m_sampleIndex+frames-1)/rate;
+    if(!m_timeAnchorValid || offset-m_timeAnchor>MaxInterpolationGap)
+    {
+        m_timeAnchor = offset;
+        m_timeAnchorValid = true;
+    }
+    else if(offset<m_timeAnchor)
+    {
+        // An early packet moves the anchor down by at most half a sample period, so its
+        // first key stays after the last key of the previous packet. The rest of the
+        // correction is spread over the following packets.
+        m_timeAnchor = qMax(offset,m_timeAnchor-MaxAnchorStep/rate);
+    }
+    else
+    {
+        m_timeAnchor += (offset-m_timeAnchor)*AnchorTracking;
+    }
+
+    for(int i=0;i<count;i++)
+    {
+        samples[i].key = m_timeAnchor+double(m_sampleIndex+i)/rate;
+    }
+    m_sampleIndex += frames;
+}
+
+void Device::setRXDecoding(bool enable)
+{
+    m_decodeRX = enable;
+}
+
+bool Device::setPacketDecoder(const QString &name)
+{
+    const PacketDecoder *decoder = PacketDecoderRegistry::instance().decoder(name);
+    if(!decoder)
+    {
+        return false;
+    }
+
+    m_decoder = decoder;
+    return true;
+}
+
+void Device::setBatchDecoding(bool enable)
+{
+    m_batchDecoding = enable;
+}
+
+QString Device::packetDecoderName() const
+{
+    return m_decoder.load()->name();
+}
+
+void Device::setTimeBase(const QElapsedTimer &timeBase)
+{
+    m_timeBase = timeBase;
+}
+
+void Device::setRecorder(CaptureRecorder *recorder, int source)
+{
+    m_recorder = recorder;
+    m_recordSource = source;
+}
+
+void Device::setSequenceChecking(bool enable)
+{
+    m_sequenceChecking = enable;
+}
+
+int Device::checkSequence(int sequence)
+{
+    if(sequence<0)
+    {
+        return 0;
+    }
+
+    // The counter wraps at 256. A repeated counter or a small step back is a duplicate or
+    // a packet that arrived late, not a gap of almost 256 notifications
+    int missing = 0;
+    if(m_lastSequence>=0)
+    {
+        const int step = (sequence-m_lastSequence)&0xFF;
+        if(step==0 || step>MaxSequenceStep)
+        {
+            m_reorderedNotifications++;
+            return -1;
+        }
+        missing = step-1;
+        if(missing>0)
+        {
+            m_sequenceGaps++;
+            m_lostNotifications += missing;
+        }
+    }
+    m_lastSequence = sequence;
+    return missing;
+}
+
+void Device::setNominalSampleRate(double hz)
+{
+    m_nominalSampleRate = qMax(hz,0.0);
+}
+
+void Device::setRXCharacteristicName(const QString &name)
+{
+    QMutexLocker lock(&m_statisticsMutex);
+    m_rxCharacteristic = name;
+}
+
+Device::RxStatistics Device::rxStatistics() const
+{
+    RxStatistics s;
+    {
+        QMutexLocker lock(&m_statisticsMutex);
+        s.characteristic = m_rxCharacteristic;
+    }
+    s.notifications = m_rxNotifications;
+    s.bytes = m_rxBytes;
+    s.samples = m_rxSamples;
+    s.decodeFailures = m_decodeFailures;
+    s.sequenceGaps = m_sequenceGaps;
+    s.lostNotifications = m_lostNotifications;
+    s.reorderedNotifications = m_reorderedNotifications;
+    s.overruns = rxRing.overrunCount();
+    return s;
+}
+
+SampleRing<RxSample> *Device::sampleRing()
+{
+    return &rxRing;
+}
+
+SampleRing<LatencyStamp> *Device::latencyRing()
+{
+    return &m_latencyRing;
+}
+
+quint64 Device::rxByteCount() const
+{
+    return m_rxBytes;
+}
+
+quint64 Device::rxNotificationCount() const
+{
+    return m_rxNotifications;
+}
+
+quint64 Device::rxSampleCount() const
+{
+    return m_rxSamples;
+}
+
+quint64 Device::rxOverrunCount() const
+{
+    return rxRing.overrunCount();
 }
 
 void Device::setTXCharacteristic(const QString &uuid)
@@ -355,28 +654,76 @@ void Device::setTXCharacteristic(const QString &uuid)
         return;
 
     writeCharacteristic = characteristic;
+    m_txReady = true;
 }
 
-void Device::writeToTXCharacteristic(QString &message)
+void Device::writeToTXCharacteristic(const QString &message)
 {
     QByteArray myMessage = message.toUtf8();
     myMessage.prepend(0x01);
     myMessage.append(0x0D);
+
+    if(m_transport)
+    {
+        m_transport->write(myMessage);
+        return;
+    }
+
+    if(!currentService || !writeCharacteristic.isValid())
+    {
+        emit consoleOutput("No Tx Characteristic connected!");
+        return;
+    }
+
     currentService->writeCharacteristic(writeCharacteristic,myMessage,QLowEnergyService::WriteWithoutResponse);
 }
 
-bool Device::getCharState()
+void Device::setTransport(DeviceTransport *transport)
 {
-    if(writeCharacteristic.isValid())
-    {
-        return 1;
-    }
-    else
+    // Parented, so it follows the Device onto the acquisition thread
+    m_transport = transport;
+    m_transport->setParent(this);
+    connect(m_transport,&DeviceTransport::notificationReceived,this,&Device::receiveRXValue);
+    connect(m_transport,&DeviceTransport::opened,this,&Device::transportOpened);
+    connect(m_transport,&DeviceTransport::closed,this,&Device::transportClosed);
+    connect(m_transport,&DeviceTransport::consoleOutput,this,&Device::consoleOutput);
+}
+
+DeviceTransport *Device::transport() const
+{
+    return m_transport;
+}
+
+void Device::openTransport()
+{
+    if(m_transport)
     {
-        return 0;
+        m_transport->open();
     }
 }
 
+void Device::transportOpened()
+{
+    m_txReady = true;
+    setRXCharacteristicName(m_transport->description());
+    emit consoleOutput("Connected to "+m_transport->description());
+}
+
+void Device::transportClosed()
+{
+    m_txReady = false;
+    // Do not interpolate keys over the outage, the counter restarts after it
+    m_lastArrival = -1;
+    m_lastSequence = -1;
+    m_timeAnchorValid = false;
+    emit consoleOutput("Device Disconnected!");
+}
+
+bool Device::getCharState()
+{
+    return m_txReady;
+}
+
 
 
 
@@ -9,9 +9,16 @@
 #include <QBluetoothDeviceDiscoveryAgent>
 #include <QLowEnergyController>
 #include <QBluetoothServiceInfo>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <atomic>
 #include "deviceinfo.h"
 #include "serviceinfo.h"
 #include "characteristicinfo.h"
+#include "samplering.h"
+#include "packetdecoder.h"
+#include "capturerecorder.h"
+#include "devicetransport.h"
 
 class Device: public QObject
 {
@@ -25,11 +32,65 @@ public:
     bool isRandomAddress() const;
     bool getCharState();
 
+    // Thread safe, may be called from the GUI thread
+    void setRXDecoding(bool enable);
+    bool setPacketDecoder(const QString &name);
+    void setBatchDecoding(bool enable);
+    QString packetDecoderName() const;
+
+    // Sample keys are seconds on this clock, shared by all devices of a capture.
+    // Must be set before the device is moved to its thread.
+    void setTimeBase(const QElapsedTimer &timeBase);
+
+    // Every decoded sample is also handed to the recorder under the given source id.
+    // Must be set before the device is moved to its thread.
+    void setRecorder(CaptureRecorder *recorder, int source);
+
+    // Replaces the Bluetooth LE data path by the given transport, the Device takes
+    // ownership. Must be set before the device is moved to its thread.
+    void setTransport(DeviceTransport *transport);
+    DeviceTransport *transport() const;
+
+    // Counters of the subscribed RX characteristic, may be read from any thread
+    struct RxStatistics
+    {
+        QString characteristic;
+        quint64 notifications = 0;
+        quint64 bytes = 0;
+        quint64 samples = 0;
+        quint64 decodeFailures = 0;
+        quint64 sequenceGaps = 0;
+        quint64 lostNotifications = 0;
+        // Duplicates and packets that arrived after a later one, they are dropped
+        quint64 reorderedNotifications = 0;
+        quint64 overruns = 0;
+    };
+    RxStatistics rxStatistics() const;
+
+    // Treat the first header byte as a wrapping packet counter and count the gaps.
+    // Gaps are also marked in the sample ring by a sample with NaN values.
+    // Duplicates and late packets (a step back of up to half the counter) are dropped.
+    void setSequenceChecking(bool enable);
+
+    // Samples per second the peripheral takes, 0 stamps the samples by arrival time.
+    // With a rate the keys follow the nominal sample clock, aligned to the earliest
+    // arrivals, and lost notifications advance it by their frames.
+    void setNominalSampleRate(double hz);
+
+    // Decoded RX samples, filled by the Device and drained by the plot
+    SampleRing<RxSample> *sampleRing();
+    // One stamp per decoded packet, drained together with the samples
+    SampleRing<LatencyStamp> *latencyRing();
+    quint64 rxByteCount() const;
+    quint64 rxNotificationCount() const;
+    quint64 rxSampleCount() const;
+    quint64 rxOverrunCount() const;
+
 private:
     QBluetoothDeviceDiscoveryAgent *discoveryAgent;
     bool m_deviceScanState = false;
     DeviceInfo currentDevice;
-    QLowEnergyService *currentService;
+    QLowEnergyService *currentService = nullptr;
     QList<DeviceInfo *> devices;
     QList<ServiceInfo *> m_services;
     QList<CharacteristicInfo *>m_characteristics;
@@ -40,6 +101,40 @@ private:
     bool randomAddress = false;
     QLowEnergyCharacteristic writeCharacteristic;
 
+    SampleRing<RxSample> rxRing{8192};
+    SampleRing<LatencyStamp> m_latencyRing{1024};
+    // Accessed from the GUI thread while the Device runs on the acquisition thread
+    std::atomic<bool> m_decodeRX{false};
+    std::atomic<bool> m_txReady{false};
+    std::atomic<quint64> m_rxBytes{0};
+    std::atomic<quint64> m_rxNotifications{0};
+    std::atomic<quint64> m_rxSamples{0};
+    std::atomic<const PacketDecoder *> m_decoder{PacketDecoderRegistry::instance().defaultDecoder()};
+    std::atomic<bool> m_batchDecoding{false};
+    std::atomic<bool> m_sequenceChecking{false};
+    std::atomic<quint64> m_decodeFailures{0};
+    std::atomic<quint64> m_sequenceGaps{0};
+    std::atomic<quint64> m_lostNotifications{0};
+    std::atomic<quint64> m_reorderedNotifications{0};
+    int m_lastSequence = -1;
+    std::atomic<double> m_nominalSampleRate{0};
+    double m_appliedSampleRate = 0;
+    double m_timeAnchor = 0;
+    bool m_timeAnchorValid = false;
+    quint64 m_sampleIndex = 0;
+    double m_lastKey = -1;
+    mutable QMutex m_statisticsMutex;
+    QString m_rxCharacteristic;
+    void setRXCharacteristicName(const QString &name);
+    int checkSequence(int sequence);
+    void reconstructKeys(RxSample *samples, int count, int frames, int missing, double arrival, double rate);
+    QElapsedTimer m_timeBase;
+    CaptureRecorder *m_recorder = nullptr;
+    int m_recordSource = -1;
+    double m_lastArrival = -1;
+    std::vector<RxSample> m_decodeBuffer;
+    DeviceTransport *m_transport = nullptr;
+    void decodeRXValue(const QByteArray &value, double arrival);
 
 public slots:
     void startDeviceDiscovery();
@@ -47,7 +142,8 @@ public slots:
     void connectToService(const QString &uuid);
     void disconnectFromDevice();
     void connectToRXCharacteristic(const QString &uuid);
-    void writeToTXCharacteristic(QString &message);
+    void writeToTXCharacteristic(const QString &message);
+    void openTransport();
     void setTXCharacteristic(const QString &uuid);
 
 
@@ -71,6 +167,11 @@ private slots:
     // QLowEnergyCharacteristic related
     void updateRXValue(const QLowEnergyCharacteristic &c, const QByteArray &value);
 
+    // Notifications of BLE and of other transports
+    void receiveRXValue(const QByteArray &value);
+    void transportOpened();
+    void transportClosed();
+
 signals:
     void consoleOutput(QString msg);
     void sendDeviceName(QString name);
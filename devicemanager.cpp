@@ -0,0 +1,202 @@
+#include "devicemanager.h"
+
+DeviceManager::DeviceManager(QObject *parent)
+    : QObject(parent)
+{
+    m_timeBase.start();
+    m_rateClock.start();
+
+    connect(&m_throughputTimer, &QTimer::timeout, this, &DeviceManager::updateThroughput);
+    m_throughputTimer.start(1000);
+
+    m_thread.start();
+}
+
+DeviceManager::~DeviceManager()
+{
+    // The devices are deleted on their thread once its event loop finished
+    m_thread.quit();
+    m_thread.wait();
+}
+
+Device *DeviceManager::addDevice(DeviceTransport *transport)
+{
+    auto device = new Device;
+    if (transport)
+        device->setTransport(transport);
+    device->setTimeBase(m_timeBase);
+    device->setRecorder(&m_recorder, m_recorder.addSource(QString("Device %1").arg(m_devices.size()+1)));
+    device->setRXDecoding(m_decodeRX);
+    device->setBatchDecoding(m_batchDecoding);
+    device->setSequenceChecking(m_sequenceChecking);
+    device->setNominalSampleRate(m_nominalSampleRate);
+    if (!m_decoderName.isEmpty())
+        device->setPacketDecoder(m_decoderName);
+
+    // The device lives on the acquisition thread, so a long replot does not delay the BLE notifications
+    device->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, device, &QObject::deleteLater);
+    connect(this, &DeviceManager::sendTXMessage, device, &Device::writeToTXCharacteristic);
+
+    m_devices.append(device);
+    m_lastCounters.append(Counters());
+    m_throughput.append(Throughput());
+
+    emit deviceAdded(device);
+
+    if (transport)
+        QMetaObject::invokeMethod(device, &Device::openTransport, Qt::QueuedConnection);
+    return device;
+}
+
+int DeviceManager::count() const
+{
+    return m_devices.size();
+}
+
+Device *DeviceManager::device(int index) const
+{
+    return m_devices.value(index, nullptr);
+}
+
+int DeviceManager::indexOf(Device *device) const
+{
+    return m_devices.indexOf(device);
+}
+
+const QList<Device *> &DeviceManager::devices() const
+{
+    return m_devices;
+}
+
+void DeviceManager::setRXDecoding(bool enable)
+{
+    m_decodeRX = enable;
+    for (auto d : std::as_const(m_devices))
+        d->setRXDecoding(enable);
+}
+
+void DeviceManager::setPacketDecoder(const QString &name)
+{
+    m_decoderName = name;
+    for (auto d : std::as_const(m_devices))
+        d->setPacketDecoder(name);
+}
+
+void DeviceManager::setBatchDecoding(bool enable)
+{
+    m_batchDecoding = enable;
+    for (auto d : std::as_const(m_devices))
+        d->setBatchDecoding(enable);
+}
+
+void DeviceManager::setSequenceChecking(bool enable)
+{
+    m_sequenceChecking = enable;
+    for (auto d : std::as_const(m_devices))
+        d->setSequenceChecking(enable);
+}
+
+void DeviceManager::setNominalSampleRate(double hz)
+{
+    m_nominalSampleRate = hz;
+    for (auto d : std::as_const(m_devices))
+        d->setNominalSampleRate(hz);
+}
+
+bool DeviceManager::anyTXReady() const
+{
+    for (auto d : std::as_const(m_devices)) {
+        if (d->getCharState())
+            return true;
+    }
+    return false;
+}
+
+double DeviceManager::captureTime() const
+{
+    return m_timeBase.nsecsElapsed()*1e-9;
+}
+
+const QElapsedTimer &DeviceManager::timeBase() const
+{
+    return m_timeBase;
+}
+
+DeviceManager::Throughput DeviceManager::throughput(int index) const
+{
+    return m_throughput.value(index);
+}
+
+CaptureRecorder *DeviceManager::recorder()
+{
+    return &m_recorder;
+}
+
+ReplaySource *DeviceManager::openReplay(const QString &filePath, QString *errorString)
+{
+    auto replay = new ReplaySource;
+    if (!replay->open(filePath)) {
+        if (errorString)
+            *errorString = replay->errorString();
+        delete replay;
+        return nullptr;
+    }
+
+    // Replays run next to the devices, so they see the same thread and scheduling
+    replay->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, replay, &QObject::deleteLater);
+
+    m_replays.append(replay);
+    emit replayAdded(replay);
+    return replay;
+}
+
+const QList<ReplaySource *> &DeviceManager::replays() const
+{
+    return m_replays;
+}
+
+void DeviceManager::startReplay(ReplaySource *replay)
+{
+    QMetaObject::invokeMethod(replay, &ReplaySource::start, Qt::QueuedConnection);
+}
+
+void DeviceManager::stopReplay(ReplaySource *replay)
+{
+    QMetaObject::invokeMethod(replay, &ReplaySource::stop, Qt::QueuedConnection);
+}
+
+void DeviceManager::updateThroughput()
+{
+    const double seconds = m_rateClock.restart()*1e-3;
+    if (seconds <= 0)
+        return;
+
+    for (int i = 0; i < m_devices.size(); i++) {
+        const Device::RxStatistics stats = m_devices.at(i)->rxStatistics();
+        Counters now;
+        now.notifications = stats.notifications;
+        now.bytes = stats.bytes;
+        now.samples = stats.samples;
+
+        const Counters &last = m_lastCounters.at(i);
+        Throughput &t = m_throughput[i];
+        t.characteristic = stats.characteristic;
+        t.notificationsPerSecond = (now.notifications - last.notifications)/seconds;
+        t.bytesPerSecond = (now.bytes - last.bytes)/seconds;
+        t.samplesPerSecond = (now.samples - last.samples)/seconds;
+        t.overruns = stats.overruns;
+        t.decodeFailures = stats.decodeFailures;
+        t.sequenceGaps = stats.sequenceGaps;
+        t.lostNotifications = stats.lostNotifications;
+        // Dropped duplicates and late packets are not part of the sequence
+        const quint64 expected = stats.notifications - qMin(stats.reorderedNotifications, stats.notifications)
+                + stats.lostNotifications;
+        t.lossRate = expected ? double(stats.lostNotifications)/double(expected) : 0;
+
+        m_lastCounters[i] = now;
+    }
+
+    emit throughputUpdated();
+}
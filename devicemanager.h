@@ -0,0 +1,105 @@
+#ifndef DEVICEMANAGER_H
+#define DEVICEMANAGER_H
+
+#include <QObject>
+#include <QList>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "device.h"
+#include "replaysource.h"
+
+// Keeps several Devices connected at the same time. Every Device has its own
+// controller, decoder and sample ring and runs on the shared acquisition
+// thread. All devices stamp their samples with the same time base, so the
+// keys of different devices can be plotted on one axis.
+class DeviceManager: public QObject
+{
+    Q_OBJECT
+
+public:
+    // Rates over the last second and totals of the RX characteristic of a device
+    struct Throughput
+    {
+        QString characteristic;
+        double notificationsPerSecond = 0;
+        double bytesPerSecond = 0;
+        double samplesPerSecond = 0;
+        quint64 overruns = 0;
+        quint64 decodeFailures = 0;
+        quint64 sequenceGaps = 0;
+        quint64 lostNotifications = 0;
+        // Lost share of the expected notifications, 0..1, needs sequence checking
+        double lossRate = 0;
+    };
+
+    DeviceManager(QObject *parent = nullptr);
+    ~DeviceManager();
+
+    // Without transport the device is set up through Bluetooth LE discovery,
+    // with one it is connected right away
+    Device *addDevice(DeviceTransport *transport = nullptr);
+    int count() const;
+    Device *device(int index) const;
+    int indexOf(Device *device) const;
+    const QList<Device *> &devices() const;
+
+    // Settings applied to all devices, including the ones added later
+    void setRXDecoding(bool enable);
+    void setPacketDecoder(const QString &name);
+    void setBatchDecoding(bool enable);
+    void setSequenceChecking(bool enable);
+    void setNominalSampleRate(double hz);
+    bool anyTXReady() const;
+
+    // Seconds since the start of the capture time base
+    double captureTime() const;
+    const QElapsedTimer &timeBase() const;
+    Throughput throughput(int index) const;
+
+    // Streams the samples of all devices to disk
+    CaptureRecorder *recorder();
+
+    // Plays a recorded capture back on the acquisition thread, nullptr if the
+    // file can not be opened. Start it with startReplay().
+    ReplaySource *openReplay(const QString &filePath, QString *errorString = nullptr);
+    const QList<ReplaySource *> &replays() const;
+    void startReplay(ReplaySource *replay);
+    void stopReplay(ReplaySource *replay);
+
+signals:
+    void deviceAdded(Device *device);
+    void replayAdded(ReplaySource *replay);
+    void sendTXMessage(const QString &message);
+    void throughputUpdated();
+
+private slots:
+    void updateThroughput();
+
+private:
+    struct Counters
+    {
+        quint64 notifications = 0;
+        quint64 bytes = 0;
+        quint64 samples = 0;
+    };
+
+    CaptureRecorder m_recorder;
+    QThread m_thread;
+    QList<Device *> m_devices;
+    QList<ReplaySource *> m_replays;
+    QList<Counters> m_lastCounters;
+    QList<Throughput> m_throughput;
+
+    QElapsedTimer m_timeBase;
+    QElapsedTimer m_rateClock;
+    QTimer m_throughputTimer;
+
+    bool m_decodeRX = false;
+    bool m_batchDecoding = false;
+    bool m_sequenceChecking = false;
+    double m_nominalSampleRate = 0;
+    QString m_decoderName;
+};
+
+#endif // DEVICEMANAGER_H
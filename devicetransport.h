@@ -0,0 +1,36 @@
+#ifndef DEVICETRANSPORT_H
+#define DEVICETRANSPORT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+
+// Data link of a Device that is not the Bluetooth LE stack, e.g. a simulated
+// peripheral. It delivers RX notifications and takes the framed TX commands,
+// the Device decodes and buffers the notifications exactly as BLE ones.
+// A transport is owned by its Device and lives on the Device's thread.
+class DeviceTransport: public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DeviceTransport(QObject *parent = nullptr) : QObject(parent) {}
+    ~DeviceTransport() override = default;
+
+    virtual QString description() const = 0;
+    virtual bool isOpen() const = 0;
+
+public slots:
+    virtual void open() = 0;
+    virtual void close() = 0;
+    // Same bytes the Device would write to the TX characteristic
+    virtual void write(const QByteArray &data) = 0;
+
+signals:
+    void notificationReceived(const QByteArray &value);
+    void opened();
+    void closed();
+    void consoleOutput(QString msg);
+};
+
+#endif // DEVICETRANSPORT_H
@@ -0,0 +1,168 @@
+#include "hexringview.h"
+
+#include <QFontDatabase>
+#include <QPainter>
+#include <QScrollBar>
+
+HexRingView::HexRingView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &HexRingView::scrollBarMoved);
+    connect(horizontalScrollBar(), &QScrollBar::valueChanged, viewport(), QOverload<>::of(&QWidget::update));
+    setCapacity(DefaultCapacity);
+}
+
+void HexRingView::setCapacity(int bytes)
+{
+    // Whole rows, so a row never straddles the wrap-around. The kept bytes are discarded.
+    const int rows = qMax(1, (bytes+BytesPerRow-1)/BytesPerRow);
+    m_ring = QByteArray(rows*BytesPerRow, 0);
+    m_begin = m_end;
+    m_topRow = m_begin/BytesPerRow;
+    updateScrollBar();
+    viewport()->update();
+}
+
+int HexRingView::capacity() const
+{
+    return int(m_ring.size());
+}
+
+qint64 HexRingView::totalBytes() const
+{
+    return m_end;
+}
+
+void HexRingView::appendData(const QByteArray &data)
+{
+    const int capacity = int(m_ring.size());
+    const char *source = data.constData();
+    qint64 count = data.size();
+
+    // Only the tail of a packet larger than the ring is kept
+    if (count > capacity) {
+        m_end += count-capacity;
+        source += count-capacity;
+        count = capacity;
+    }
+
+    while (count > 0) {
+        const int position = int(m_end%capacity);
+        const int chunk = int(qMin<qint64>(count, capacity-position));
+        memcpy(m_ring.data()+position, source, size_t(chunk));
+        source += chunk;
+        count -= chunk;
+        m_end += chunk;
+    }
+    m_begin = qMax(m_begin, m_end-capacity);
+
+    updateScrollBar();
+    viewport()->update();
+}
+
+void HexRingView::clear()
+{
+    m_begin = m_end = 0;
+    m_topRow = 0;
+    m_followTail = true;
+    updateScrollBar();
+    viewport()->update();
+}
+
+void HexRingView::paintEvent(QPaintEvent *)
+{
+    QPainter painter(viewport());
+    painter.setFont(font());
+    const QFontMetrics metrics(font());
+    const int lineHeight = metrics.lineSpacing();
+    const int x = 4-horizontalScrollBar()->value();
+
+    const qint64 lastRow = m_end > m_begin ? (m_end-1)/BytesPerRow : m_topRow-1;
+    const int rows = visibleRows();
+    for (int i = 0; i < rows; i++) {
+        const qint64 row = m_topRow+i;
+        if (row > lastRow)
+            break;
+        painter.drawText(x, i*lineHeight+metrics.ascent(), formatRow(row));
+    }
+}
+
+void HexRingView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+
+    // All rows have the same width in a fixed font
+    const int rowWidth = QFontMetrics(font()).horizontalAdvance(formatRow(0))+8;
+    horizontalScrollBar()->setRange(0, qMax(0, rowWidth-viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    updateScrollBar();
+}
+
+void HexRingView::updateScrollBar()
+{
+    const qint64 firstRow = m_begin/BytesPerRow;
+    const qint64 rowCount = m_end > m_begin ? (m_end-1)/BytesPerRow-firstRow+1 : 0;
+    const int maximum = int(qMax<qint64>(0, rowCount-visibleRows()));
+
+    // Follow the new rows at the end, or keep the rows in view that are still kept
+    if (m_followTail)
+        m_topRow = firstRow+maximum;
+    else
+        m_topRow = qBound(firstRow, m_topRow, firstRow+maximum);
+
+    m_updatingScrollBar = true;
+    verticalScrollBar()->setRange(0, maximum);
+    verticalScrollBar()->setPageStep(visibleRows());
+    verticalScrollBar()->setValue(int(m_topRow-firstRow));
+    m_updatingScrollBar = false;
+}
+
+void HexRingView::scrollBarMoved(int value)
+{
+    if (m_updatingScrollBar)
+        return;
+    m_topRow = m_begin/BytesPerRow+value;
+    m_followTail = value == verticalScrollBar()->maximum();
+    viewport()->update();
+}
+
+int HexRingView::visibleRows() const
+{
+    const int lineHeight = QFontMetrics(font()).lineSpacing();
+    return qMax(1, viewport()->height()/qMax(1, lineHeight));
+}
+
+int HexRingView::byteAt(qint64 offset) const
+{
+    if (offset < m_begin || offset >= m_end)
+        return -1;
+    return quint8(m_ring.at(int(offset%m_ring.size())));
+}
+
+QString HexRingView::formatRow(qint64 row) const
+{
+    // 00001230  48 65 6c 6c 6f 00 ...  |Hello.          |
+    static const char digits[] = "0123456789abcdef";
+    QString hex;
+    QString ascii;
+    hex.reserve(BytesPerRow*3+1);
+    ascii.reserve(BytesPerRow);
+    for (int i = 0; i < BytesPerRow; i++) {
+        const int value = byteAt(row*BytesPerRow+i);
+        if (i == BytesPerRow/2)
+            hex += ' ';
+        if (value < 0) {
+            hex += QLatin1String("   ");
+            ascii += ' ';
+            continue;
+        }
+        hex += QChar(digits[value >> 4]);
+        hex += QChar(digits[value & 0xf]);
+        hex += ' ';
+        ascii += (value >= 0x20 && value < 0x7f) ? QChar(value) : QChar('.');
+    }
+    return QString("%1  %2 |%3|").arg(row*BytesPerRow, 8, 16, QChar('0')).arg(hex, ascii);
+}
@@ -0,0 +1,53 @@
+#ifndef HEXRINGVIEW_H
+#define HEXRINGVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+
+// Hex/ASCII dump of the most recent received bytes. The bytes are kept in a
+// ring of fixed capacity, the oldest are overwritten. Appending only copies
+// the bytes and schedules a repaint, painting formats just the rows that are
+// visible, so the cost does not grow with the history. Rows are addressed by
+// the absolute byte offset since the last clear(). While scrolled to the end
+// the view follows new data.
+class HexRingView: public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit HexRingView(QWidget *parent = nullptr);
+
+    void setCapacity(int bytes);
+    int capacity() const;
+    // Bytes appended since the last clear, including the overwritten ones
+    qint64 totalBytes() const;
+
+    static const int BytesPerRow = 16;
+    static const int DefaultCapacity = 64*1024;
+
+public slots:
+    void appendData(const QByteArray &data);
+    void clear();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void updateScrollBar();
+    void scrollBarMoved(int value);
+    int visibleRows() const;
+    int byteAt(qint64 offset) const;
+    QString formatRow(qint64 row) const;
+
+    QByteArray m_ring;
+    // Absolute offsets of the oldest kept byte and one past the newest
+    qint64 m_begin = 0;
+    qint64 m_end = 0;
+    // Absolute row at the top of the view
+    qint64 m_topRow = 0;
+    bool m_followTail = true;
+    bool m_updatingScrollBar = false;
+};
+
+#endif // HEXRINGVIEW_H
@@ -0,0 +1,190 @@
+#include "latencymonitor.h"
+#include "qcustomplot.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <cmath>
+
+void LatencyHistogram::add(double seconds)
+{
+    seconds = qMax(seconds, 0.0);
+    int bin = 0;
+    if (seconds > MinimumValue)
+        bin = qMin(int(std::log10(seconds/MinimumValue)*BinsPerDecade), BinCount - 1);
+
+    m_bins[size_t(bin)]++;
+    m_count++;
+    m_sum += seconds;
+    m_maximum = qMax(m_maximum, seconds);
+}
+
+void LatencyHistogram::clear()
+{
+    m_bins.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_maximum = 0;
+}
+
+quint64 LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+double LatencyHistogram::mean() const
+{
+    return m_count ? m_sum/double(m_count) : 0;
+}
+
+double LatencyHistogram::maximum() const
+{
+    return m_maximum;
+}
+
+double LatencyHistogram::percentile(double fraction) const
+{
+    if (m_count == 0)
+        return 0;
+
+    const quint64 rank = quint64(std::ceil(qBound(0.0, fraction, 1.0)*double(m_count)));
+    quint64 seen = 0;
+    for (int i = 0; i < BinCount; i++) {
+        seen += m_bins[size_t(i)];
+        if (seen >= rank && seen > 0)
+            return qMin(binLowerEdge(i + 1), m_maximum);
+    }
+    return m_maximum;
+}
+
+quint64 LatencyHistogram::binCount(int bin) const
+{
+    return m_bins[size_t(bin)];
+}
+
+double LatencyHistogram::binLowerEdge(int bin)
+{
+    return bin == 0 ? 0 : MinimumValue*std::pow(10.0, double(bin)/BinsPerDecade);
+}
+
+LatencyMonitor::LatencyMonitor(QCustomPlot *plot, const QElapsedTimer &timeBase, QObject *parent)
+    : QObject(parent)
+    , m_timeBase(timeBase)
+{
+    m_pending.reserve(MaxPendingStamps);
+    m_replotting.reserve(MaxPendingStamps);
+    connect(plot, &QCustomPlot::beforeReplot, this, &LatencyMonitor::onBeforeReplot);
+    connect(plot, &QCustomPlot::afterReplot, this, &LatencyMonitor::onAfterReplot);
+}
+
+double LatencyMonitor::now() const
+{
+    return m_timeBase.nsecsElapsed()*1e-9;
+}
+
+void LatencyMonitor::addDrained(const LatencyStamp *stamps, int count)
+{
+    const double drained = now();
+    for (int i = 0; i < count && m_pending.size() < MaxPendingStamps; i++) {
+        Pending p;
+        p.stamp = stamps[i];
+        p.drained = drained;
+        m_pending.append(p);
+    }
+}
+
+void LatencyMonitor::onBeforeReplot()
+{
+    // Everything drained so far is in the graphs and shown by this replot
+    m_replotStart = now();
+    m_replotting.swap(m_pending);
+    m_pending.clear();
+}
+
+void LatencyMonitor::onAfterReplot()
+{
+    const double painted = now();
+    for (const Pending &p : std::as_const(m_replotting)) {
+        m_histograms[Decode].add(p.stamp.decoded - p.stamp.arrival);
+        m_histograms[Buffer].add(p.stamp.buffered - p.stamp.decoded);
+        m_histograms[Queue].add(p.drained - p.stamp.buffered);
+        m_histograms[RenderWait].add(m_replotStart - p.drained);
+        m_histograms[Replot].add(painted - m_replotStart);
+        m_histograms[Total].add(painted - p.stamp.arrival);
+    }
+    m_replotting.clear();
+}
+
+const LatencyHistogram &LatencyMonitor::histogram(Stage stage) const
+{
+    return m_histograms[size_t(stage)];
+}
+
+QString LatencyMonitor::stageName(Stage stage)
+{
+    switch (stage) {
+    case Decode: return "Decode";
+    case Buffer: return "Buffer";
+    case Queue: return "Queue";
+    case RenderWait: return "Render wait";
+    case Replot: return "Replot";
+    case Total: return "Total";
+    default: return QString();
+    }
+}
+
+QString LatencyMonitor::summary() const
+{
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5").arg("Latency [ms]", -12).arg("count", 10).arg("p50", 8).arg("p99", 8).arg("max", 8);
+    for (int s = 0; s < StageCount; s++) {
+        const LatencyHistogram &h = m_histograms[size_t(s)];
+        lines << QString("%1 %2 %3 %4 %5")
+                 .arg(stageName(Stage(s)), -12)
+                 .arg(h.count(), 10)
+                 .arg(h.percentile(0.5)*1e3, 8, 'f', 3)
+                 .arg(h.percentile(0.99)*1e3, 8, 'f', 3)
+                 .arg(h.maximum()*1e3, 8, 'f', 3);
+    }
+    return lines.join('\n');
+}
+
+bool LatencyMonitor::exportCsv(const QString &filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+
+    // Summary per stage, then the histograms
+    out << "stage,count,mean_ms,p50_ms,p99_ms,max_ms\n";
+    for (int s = 0; s < StageCount; s++) {
+        const LatencyHistogram &h = m_histograms[size_t(s)];
+        out << stageName(Stage(s)) << ',' << h.count() << ','
+            << h.mean()*1e3 << ',' << h.percentile(0.5)*1e3 << ','
+            << h.percentile(0.99)*1e3 << ',' << h.maximum()*1e3 << '\n';
+    }
+
+    out << "\nstage,lower_ms,upper_ms,count\n";
+    for (int s = 0; s < StageCount; s++) {
+        const LatencyHistogram &h = m_histograms[size_t(s)];
+        for (int i = 0; i < LatencyHistogram::BinCount; i++) {
+            if (h.binCount(i) == 0)
+                continue;
+            out << stageName(Stage(s)) << ','
+                << LatencyHistogram::binLowerEdge(i)*1e3 << ','
+                << LatencyHistogram::binLowerEdge(i + 1)*1e3 << ','
+                << h.binCount(i) << '\n';
+        }
+    }
+    return out.status() == QTextStream::Ok;
+}
+
+void LatencyMonitor::reset()
+{
+    for (LatencyHistogram &h : m_histograms)
+        h.clear();
+    m_pending.clear();
+    m_replotting.clear();
+}
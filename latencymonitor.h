@@ -0,0 +1,93 @@
+#ifndef LATENCYMONITOR_H
+#define LATENCYMONITOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+#include <array>
+#include "samplering.h"
+
+class QCustomPlot;
+
+// Latency histogram with logarithmic bins from 1 us to 10 s.
+// Adding a value is O(1), percentiles are accurate to the bin width (about 12 %).
+class LatencyHistogram
+{
+public:
+    static const int BinsPerDecade = 20;
+    static const int Decades = 7;
+    static const int BinCount = BinsPerDecade*Decades;
+    static constexpr double MinimumValue = 1e-6;
+
+    void add(double seconds);
+    void clear();
+
+    quint64 count() const;
+    double mean() const;
+    double maximum() const;
+    // Upper edge of the bin holding the given fraction (0..1) of the values
+    double percentile(double fraction) const;
+
+    quint64 binCount(int bin) const;
+    static double binLowerEdge(int bin);
+
+private:
+    std::array<quint64, BinCount> m_bins{};
+    quint64 m_count = 0;
+    double m_sum = 0;
+    double m_maximum = 0;
+};
+
+// Measures how long RX packets take from the notification to the pixels.
+// The Devices stamp every packet at arrival, after decoding and after the
+// ring insertion. The owner of the plot hands the stamps over when it drains
+// the rings, the monitor adds the replot start (QCustomPlot::beforeReplot) and
+// the paint completion (QCustomPlot::afterReplot) of the replot that shows
+// the samples. Lives on the GUI thread.
+class LatencyMonitor: public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Stage { Decode, Buffer, Queue, RenderWait, Replot, Total, StageCount };
+
+    LatencyMonitor(QCustomPlot *plot, const QElapsedTimer &timeBase, QObject *parent = nullptr);
+
+    // Stamps of the packets whose samples were just moved into the graphs
+    void addDrained(const LatencyStamp *stamps, int count);
+
+    const LatencyHistogram &histogram(Stage stage) const;
+    static QString stageName(Stage stage);
+
+    // One line per stage with count, p50, p99 and max in ms
+    QString summary() const;
+    bool exportCsv(const QString &filePath) const;
+    void reset();
+
+    // Stamps kept for one replot, the oldest are dropped if the plot stalls
+    static const int MaxPendingStamps = 65536;
+
+private slots:
+    void onBeforeReplot();
+    void onAfterReplot();
+
+private:
+    double now() const;
+
+    QElapsedTimer m_timeBase;
+    std::array<LatencyHistogram, StageCount> m_histograms;
+
+    struct Pending
+    {
+        LatencyStamp stamp;
+        double drained = 0;
+    };
+    // Drained, waiting for the replot
+    QVector<Pending> m_pending;
+    // Part of the running replot
+    QVector<Pending> m_replotting;
+    double m_replotStart = 0;
+};
+
+#endif // LATENCYMONITOR_H
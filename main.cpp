@@ -1,11 +1,75 @@
 #include "mainwindow.h"
+#include "rxkernels.h"
 
 #include <QApplication>
+#include <QDebug>
+#include <QTimer>
+#include <cstdlib>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
+    // Run the RX conversion microbenchmark without opening a window
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--bench-rx") == 0) {
+            qInfo().noquote() << RxKernels::benchmark();
+            return 0;
+        }
+    }
+
+    // Load test with a simulated peripheral:
+    //   --simulate=rate=1000,frames=10,jitter=2,drop=0.01 --duration=60 --headless [--raster] [--keep-history]
+    // --keep-history plots every sample instead of the newest max points, e.g. 3x100k points
+    // after 10 s of --simulate=rate=1000,frames=10
+    QString simulation;
+    bool simulate = false;
+    bool headless = false;
+    bool raster = false;
+    bool keepHistory = false;
+    int duration = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--simulate") == 0) {
+            simulate = true;
+        } else if (std::strncmp(argv[i], "--simulate=", 11) == 0) {
+            simulate = true;
+            simulation = QString::fromLocal8Bit(argv[i] + 11);
+        } else if (std::strncmp(argv[i], "--duration=", 11) == 0) {
+            duration = std::atoi(argv[i] + 11);
+        } else if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--raster") == 0) {
+            raster = true;
+        } else if (std::strcmp(argv[i], "--keep-history") == 0) {
+            keepHistory = true;
+        }
+    }
+
+    // Renders into memory, no display needed
+    if (headless)
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
     QApplication a(argc, argv);
     MainWindow w;
+    w.setRasterRendering(raster);
+    w.setKeepHistory(keepHistory);
     w.show();
+
+    if (simulate) {
+        bool ok = false;
+        const SimulatedPeripheral::Settings settings = SimulatedPeripheral::parseSettings(simulation, &ok);
+        if (!ok) {
+            qWarning() << "Invalid simulation settings:" << simulation;
+            return 1;
+        }
+        w.startSimulation(settings);
+    }
+
+    if (duration > 0) {
+        QTimer::singleShot(duration*1000, &a, [&w] {
+            qInfo().noquote() << w.pipelineReport();
+            QApplication::quit();
+        });
+    }
+
     return a.exec();
 }
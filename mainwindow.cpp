@@ -2,6 +2,7 @@
 #include "ui_mainwindow.h"
 #include <QFile>
 #include <QDataStream>
+#include <QFontDatabase>
 #include <QTimer>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -10,42 +11,92 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
-    // Set up the plot Widget
-
-    // Add Graph 0
-    ui->customplot->addGraph();
-    ui->customplot->graph(0)->setScatterStyle(QCPScatterStyle::ssCircle);
-    ui->customplot->graph(0)->setLineStyle(QCPGraph::lsLine);
-    ui->customplot->graph(0)->setPen(QPen(Qt::blue));
-
-    // Add Graph 1
-    ui->customplot->addGraph();
-    ui->customplot->graph(1)->setScatterStyle(QCPScatterStyle::ssCircle);
-    ui->customplot->graph(1)->setLineStyle(QCPGraph::lsLine);
-    ui->customplot->graph(1)->setPen(QPen(Qt::red));
-
-    // Add Graph 2
-    ui->customplot->addGraph();
-    ui->customplot->graph(2)->setScatterStyle(QCPScatterStyle::ssCircle);
-    ui->customplot->graph(2)->setLineStyle(QCPGraph::lsLine);
-    ui->customplot->graph(2)->setPen(QPen(Qt::green));
-
-    ui->customplot->xAxis->setLabel("X");
+    // Set up the plot Widget, every device adds its own set of graphs
+    ui->customplot->xAxis->setLabel("Time [s]");
     ui->customplot->yAxis->setLabel("Y");
     ui->customplot->xAxis->setRange(-6000,100);
     ui->customplot->yAxis->setRange(-6000,8000);
-
+    // Graphs get their own buffered layer, axes and grid are only redrawn when the ranges change
+    ui->customplot->setStreamingMode(true);
+    // The Y axis follows the extremes of the shown points without scanning the graphs
+    valueAutoscale = new StreamingAutoscale(ui->customplot->yAxis,this);
 
     // Set up the slider object
     ui->setMaxPointsSlider->setMinimum(100);
     ui->setMaxPointsSlider->setMaximum(500);
     ui->setMaxPointsSlider->setValue(200);
 
+    // All devices run on the acquisition thread of the device manager
+    deviceManager = new DeviceManager(this);
+    connect(deviceManager,&DeviceManager::deviceAdded,this,&MainWindow::addDevicePlot);
+    connect(deviceManager,&DeviceManager::replayAdded,this,&MainWindow::addReplayPlots);
+    connect(deviceManager,&DeviceManager::throughputUpdated,this,&MainWindow::showThroughput);
+
+    // Send messages to all devices
+    connect(this,&MainWindow::sendTXMessage,deviceManager,&DeviceManager::sendTXMessage);
+
+    // Packet layouts the devices can decode
+    ui->decoderBox->addItems(PacketDecoderRegistry::instance().names());
+
+    // Start with one device
+    setActiveDevice(deviceManager->addDevice());
+
+    // Console lines are batched, the widget would not keep up with every notification
+    consoleSink = new ConsoleSink(ui->console,this);
+
+    // Clear Console
+    connect(ui->clearConsoleButton,&QPushButton::clicked,consoleSink,&ConsoleSink::clear);
+    connect(ui->clearConsoleButton,&QPushButton::clicked,ui->hexView,&HexRingView::clear);
+
+    // Drain the decoded samples into the plot once per frame
+    renderScheduler = new RenderScheduler(ui->customplot,this);
+    connect(renderScheduler,&RenderScheduler::frameTick,this,&MainWindow::drainSampleRing);
+    on_frameRateBox_currentIndexChanged(ui->frameRateBox->currentIndex());
+
+    // Time from the notification to the pixels, shown as an overlay in the plot
+    latencyMonitor = new LatencyMonitor(ui->customplot,deviceManager->timeBase(),this);
+    latencyText = new QCPItemText(ui->customplot);
+    latencyText->setPositionAlignment(Qt::AlignTop|Qt::AlignRight);
+    latencyText->position->setType(QCPItemPosition::ptAxisRectRatio);
+    latencyText->position->setCoords(0.99,0.01);
+    latencyText->setTextAlignment(Qt::AlignLeft);
+    latencyText->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    latencyText->setBrush(QBrush(QColor(255,255,255,220)));
+    latencyText->setPadding(QMargins(4,4,4,4));
+    latencyText->setVisible(false);
+}
+
+MainWindow::~MainWindow()
+{
+    // Stops the acquisition thread before the widgets go away
+    delete deviceManager;
+    delete ui;
+}
+
+void MainWindow::setActiveDevice(Device *newDevice)
+{
+    // Detach the combo boxes and buttons from the previous device
+    if(device)
+    {
+        disconnect(ui->searchButton,nullptr,device,nullptr);
+        disconnect(ui->disconnectButton,nullptr,device,nullptr);
+        disconnect(ui->comboBox_device,nullptr,device,nullptr);
+        disconnect(ui->comboBox_service,nullptr,device,nullptr);
+        disconnect(ui->comboBox_Rx,nullptr,device,nullptr);
+        disconnect(ui->comboBox_Tx,nullptr,device,nullptr);
+        disconnect(device,&Device::sendDeviceName,this,nullptr);
+        disconnect(device,&Device::sendServiceUUID,this,nullptr);
+        disconnect(device,&Device::refreshServiceUUID,this,nullptr);
+        disconnect(device,&Device::sendCharacteristicsUUID,this,nullptr);
+        disconnect(device,&Device::refreshCharacteristicsUUID,this,nullptr);
+    }
+
+    device = newDevice;
+
     //Set up the connections to the device class
 
     // Device discovery related
     connect(ui->searchButton,&QPushButton::clicked,device,&Device::startDeviceDiscovery);
-    connect(device,&Device::consoleOutput,this,&MainWindow::writeToConsole);
     connect(device,&Device::sendDeviceName,this,&MainWindow::addDeviceNames);
 
     // Service discovery related
@@ -56,24 +107,129 @@ MainWindow::MainWindow(QWidget *parent)
     connect(device,&Device::sendCharacteristicsUUID,this,&MainWindow::addCharacteristicsUUID);
     connect(device,&Device::refreshCharacteristicsUUID,this,&MainWindow::refreshCharacteristicsUUID);
 
-    // Connect receive RX Data function
-    connect(device,&Device::sendRXValue,this,&MainWindow::receiveRXValue);
+    // Set service discovery on selected combobox item
+    connect(ui->comboBox_device,&QComboBox::currentTextChanged,device,&Device::scanService);
+    connect(ui->comboBox_service,&QComboBox::currentTextChanged,device,&Device::connectToService);
+
+    // Set characteristics connections
+    connect(ui->comboBox_Rx,&QComboBox::currentTextChanged,device,&Device::connectToRXCharacteristic);
+    connect(ui->comboBox_Tx,&QComboBox::currentTextChanged,device,&Device::setTXCharacteristic);
 
     // Handle Disconnects
     connect(ui->disconnectButton,&QPushButton::clicked,device,&Device::disconnectFromDevice);
+}
 
-    // Clear Console
-    connect(ui->clearConsoleButton,&QPushButton::clicked,ui->console,&QPlainTextEdit::clear);
+void MainWindow::addDevicePlot(Device *newDevice)
+{
+    int index = deviceManager->indexOf(newDevice);
+    QString label = QString("Device %1").arg(index+1);
+    addPlot(newDevice->sampleRing(),label,newDevice->latencyRing());
+
+    // Every device reports to the console, the combo boxes only follow the active one
+    connect(newDevice,&Device::consoleOutput,this,[this,label](QString msg){
+        writeToConsole(label+": "+msg);
+    });
+    connect(newDevice,&Device::sendRXValue,this,&MainWindow::receiveRXValue);
+}
 
-    // Timer for updating the plot in a specific interval
-    //connect(&updatePlot_timer, &QTimer::timeout, this, &MainWindow::convertAndPlot);
-    //updatePlot_timer.setInterval(5000);
+void MainWindow::addReplayPlots(ReplaySource *replay)
+{
+    // One graph set per recorded source, drained like a device
+    for(int i=0;i<replay->sourceCount();i++)
+    {
+        addPlot(replay->sampleRing(i),"Replay "+replay->sourceName(i));
+    }
+    connect(replay,&ReplaySource::consoleOutput,this,&MainWindow::writeToConsole);
+}
 
+void MainWindow::addPlot(SampleRing<RxSample> *ring, const QString &label, SampleRing<LatencyStamp> *latencyRing)
+{
+    int index = devicePlots.size();
+
+    DevicePlot plot;
+    plot.ring = ring;
+    plot.latencyRing = latencyRing;
+    plot.graph_x = addChannelGraph(label+" X",Qt::blue,index);
+    plot.graph_y = addChannelGraph(label+" Y",Qt::red,index);
+    plot.graph_z = addChannelGraph(label+" Z",Qt::green,index);
+    devicePlots.append(plot);
 }
 
-MainWindow::~MainWindow()
+QCPGraph *MainWindow::addChannelGraph(const QString &name, const QColor &color, int deviceIndex)
 {
-    delete ui;
+    // Further devices use darker colors and dashed lines
+    QPen pen(color.darker(100+60*deviceIndex));
+    if(deviceIndex>0)
+    {
+        pen.setStyle(Qt::DashLine);
+    }
+
+    QCPGraph *graph = ui->customplot->addGraph();
+    graph->setName(name);
+    graph->setScatterStyle(QCPScatterStyle::ssCircle);
+    graph->setLineStyle(QCPGraph::lsLine);
+    graph->setPen(pen);
+    graph->setRasterRendering(ui->rasterBox->isChecked());
+    return graph;
+}
+
+void MainWindow::showThroughput()
+{
+    // One row per device and its RX characteristic
+    ui->statsTable->setRowCount(deviceManager->count());
+    for(int i=0;i<deviceManager->count();i++)
+    {
+        DeviceManager::Throughput t = deviceManager->throughput(i);
+        QStringList cells;
+        cells << QString("Device %1").arg(i+1)
+              << t.characteristic
+              << QString::number(t.notificationsPerSecond,'f',0)
+              << QString::number(t.bytesPerSecond,'f',0)
+              << QString::number(t.samplesPerSecond,'f',0)
+              << QString::number(t.decodeFailures)
+              << QString::number(t.sequenceGaps)
+              << QString::number(t.lostNotifications)
+              << QString::number(t.lossRate*100,'f',2)
+              << QString::number(t.overruns);
+        for(int column=0;column<cells.size();column++)
+        {
+            QTableWidgetItem *item = ui->statsTable->item(i,column);
+            if(!item)
+            {
+                item = new QTableWidgetItem;
+                ui->statsTable->setItem(i,column,item);
+            }
+            item->setText(cells.at(column));
+        }
+    }
+
+    QStringList parts;
+    CaptureRecorder *recorder = deviceManager->recorder();
+    if(ui->recordBox->isChecked() && !recorder->isRecording())
+    {
+        // The recorder ended the recording because writing failed
+        ui->recordBox->setChecked(false);
+    }
+    if(recorder->isRecording())
+    {
+        parts << QString("Recording: %1 samples, %2 dropped")
+                 .arg(recorder->samplesWritten())
+                 .arg(recorder->samplesDropped());
+    }
+    ui->statusbar->showMessage(parts.join(" | "));
+
+    updateLatencyOverlay();
+}
+
+void MainWindow::updateLatencyOverlay()
+{
+    if(!ui->latencyBox->isChecked())
+    {
+        return;
+    }
+
+    latencyText->setText(latencyMonitor->summary());
+    ui->customplot->replot(QCustomPlot::rpQueuedReplot);
 }
 
 
@@ -88,21 +244,13 @@ void MainWindow::addDeviceNames(QString name)
 
 void MainWindow::writeToConsole(QString msg)
 {
-    ui->console->appendPlainText(msg);
+    consoleSink->append(msg);
 }
 
 void MainWindow::on_searchButton_clicked()
 {
 
     this->refreshDeviceList();
-
-    // Set service discovery on selected combobox item
-    connect(ui->comboBox_device,&QComboBox::currentTextChanged,device,&Device::scanService);
-    connect(ui->comboBox_service,&QComboBox::currentTextChanged,device,&Device::connectToService);
-
-    // Set characteristics connections
-    connect(ui->comboBox_Rx,&QComboBox::currentTextChanged,device,&Device::connectToRXCharacteristic);
-    connect(ui->comboBox_Tx,&QComboBox::currentTextChanged,device,&Device::setTXCharacteristic);
 }
 
 void MainWindow::refreshDeviceList()
@@ -149,60 +297,66 @@ void MainWindow::on_disconnectButton_clicked()
 void MainWindow::on_sendButton_clicked()
 {
     QString message = ui->lineEdit->text();
-    device->writeToTXCharacteristic(message);
+    emit sendTXMessage(message);
 }
 
 void MainWindow::receiveRXValue(const QByteArray &value)
 {
-    qDebug() << value.length();
-    QString Data = QString(value);
-    ui->console->appendPlainText("Data send:");
-    ui->console->appendPlainText(Data);
+    // Raw bytes go to the hex view, the text to the batched console
+    ui->hexView->appendData(value);
+    writeToConsole("Data send: "+QString::fromUtf8(value));
 }
 
 
-void MainWindow::receiveRXValueToInt(const QByteArray &value)
+void MainWindow::drainSampleRing()
 {
-    //The value Array contains the bytes send via Bluetooth
-    value_length += value.length()-1;
-    qDebug() << value_length;
+    int total = 0;
+    // Data updates behind this frame, one per packet, or one per replay source
+    int updates = 0;
 
-    //Only accept Data in the correct format
-    if(value.length()<7)
+    // Take everything the devices decoded since the last call
+    for(DevicePlot &plot : devicePlots)
     {
-        return;
-    }
+        // Stamps first, their samples are in the ring already
+        int stamps = 0;
+        if(plot.latencyRing)
+        {
+            latencyBuffer.resize(plot.latencyRing->size());
+            stamps = plot.latencyRing->pop(latencyBuffer.data(),latencyBuffer.size());
+            latencyMonitor->addDrained(latencyBuffer.constData(),stamps);
+        }
+
+        SampleRing<RxSample> *ring = plot.ring;
+        int available = ring->size();
+        if(available<=0)
+        {
+            continue;
+        }
 
-    // Initialize an Array where the data will be stored temporarily
-    int arrayLength = (int)(value.length()/2);
-    int16_t dataPoints[arrayLength];
+        drainBuffer.resize(available);
+        int count = ring->pop(drainBuffer.data(),available);
 
-    // Fill the temp Data array with 0
-    for(int i=0;i<arrayLength;i++)
-    {
-        dataPoints[i]=0;
+        plot.newData_x.resize(count);
+        plot.newData_y.resize(count);
+        plot.newData_z.resize(count);
+        for(int i=0;i<count;i++)
+        {
+            const RxSample &sample = drainBuffer[i];
+            plot.newData_x[i] = QCPGraphData(sample.key,sample.x);
+            plot.newData_y[i] = QCPGraphData(sample.key,sample.y);
+            plot.newData_z[i] = QCPGraphData(sample.key,sample.z);
+        }
+        total += count;
+        updates += plot.latencyRing ? qMax(stamps,1) : 1;
     }
 
-    // Fill the temp Data array with the correct values
-    for(int i=0;i<arrayLength;i++)
+    if(total==0)
     {
-        unsigned char HV = value[2*i+1];
-        unsigned char LV = value[2*i+2];
-
-        dataPoints[i] |=  (HV<<8)|(LV);
-        //qDebug() << dataPoints[i];
+        return;
     }
 
-    // Add the new data to the correct array
-    plotDataValues_x.append(dataPoints[0]);
-    plotDataValues_y.append(dataPoints[1]);
-    plotDataValues_z.append(dataPoints[2]);
-
-    plotCNT++;
-    if(plotCNT==1){
-        this->updatePlot();
-        plotCNT=0;
-    }
+    this->updatePlot();
+    renderScheduler->requestReplot(updates);
 }
 
 void MainWindow::saveAccDataToByteArray(const QByteArray &value)
@@ -214,7 +368,6 @@ void MainWindow::saveAccDataToByteArray(const QByteArray &value)
     QByteArray data = value;
     data.remove(0,1);
 
-    value_length += data.length();
     uint8_t intdata = (uint8_t)data[0];
     qDebug() << intdata;
 
@@ -246,48 +399,103 @@ void MainWindow::convertRawToIntData()
 
 }
 
-void MainWindow::updatePlot()
+void MainWindow::appendGraphData(QCPGraph *graph, const QVector<QCPGraphData> &newData, int maxDataPoints)
 {
-
-    int valueLength = plotDataValues_x.length();
-
-
-    if(!(ui->Dis_max_data->isChecked()))
+    QSharedPointer<QCPGraphDataContainer> data = graph->data();
+    if(maxDataPoints==0)
     {
-        int maxDataPoints = ui->setMaxPointsSlider->value();
-        if(valueLength>=maxDataPoints)
+        // The whole history is kept in columns, the graph only takes the points it draws from them.
+        // The keys are stored exactly. They only stay implicit while they follow the nominal rate,
+        // gap markers, anchor corrections and arrival time keys make them explicit
+        if(!graph->columns())
         {
-            for(int i=0;i<=(valueLength-maxDataPoints);i++)
+            QSharedPointer<QCPGraphColumns> columns(new QCPGraphColumns);
+            if(ui->sampleRateBox->value()>0)
             {
-                plotDataValues_x.pop_front();
-                plotDataValues_y.pop_front();
-                plotDataValues_z.pop_front();
+                columns->setKeyStep(1.0/ui->sampleRateBox->value());
             }
+            columns->add(*data);
+            data->setCapacity(0);
+            graph->setColumns(columns);
         }
-        valueLength = plotDataValues_x.length();
+        graph->columns()->add(newData);
+        valueAutoscale->addData(graph,newData);
+        return;
+    }
+    if(graph->columns())
+    {
+        // Back to a limited history, the graph holds the newest points itself again
+        QSharedPointer<QCPGraphColumns> columns = graph->columns();
+        graph->setColumns(QSharedPointer<QCPGraphColumns>());
+        data->set(columns->toGraphData(columns->size()-maxDataPoints,columns->size()),true);
     }
 
-    plotDataKeys.clear();
-    for(int i=0;i<valueLength;i++)
+    // The container keeps the newest points as a ring buffer, so it doesn't allocate while streaming
+    if(data->capacity()!=maxDataPoints)
     {
-        plotDataKeys.append(i);
+        data->setCapacity(maxDataPoints);
     }
 
-    ui->customplot->graph(0)->setData(plotDataKeys,plotDataValues_x);
-    ui->customplot->graph(1)->setData(plotDataKeys,plotDataValues_y);
-    ui->customplot->graph(2)->setData(plotDataKeys,plotDataValues_z);
+    // The new points are sorted and newer than everything in the graph, so this only appends
+    data->add(newData,true);
+    valueAutoscale->addData(graph,newData);
+}
+
+QVector<double> MainWindow::graphValues(QCPGraph *graph) const
+{
+    QVector<double> values;
+    if(QSharedPointer<QCPGraphColumns> columns = graph->columns())
+    {
+        // The data container only holds the drawn points
+        values.resize(columns->size());
+        for(int i=0;i<columns->size();i++)
+        {
+            values[i] = columns->valueAt(i);
+        }
+        return values;
+    }
+    values.reserve(graph->data()->size());
+    for(auto it=graph->data()->constBegin();it!=graph->data()->constEnd();++it)
+    {
+        values.append(it->value);
+    }
+    return values;
+}
+
+void MainWindow::updatePlot()
+{
+    // 0 keeps the whole history
+    int maxDataPoints = 0;
+    if(!(ui->Dis_max_data->isChecked()))
+    {
+        maxDataPoints = ui->setMaxPointsSlider->value();
+    }
 
     bool en_x = ui->en_x_axis->isChecked();
     bool en_y = ui->en_y_axis->isChecked();
     bool en_z = ui->en_z_axis->isChecked();
 
-    ui->customplot->graph(0)->setVisible(en_x);
-    ui->customplot->graph(1)->setVisible(en_y);
-    ui->customplot->graph(2)->setVisible(en_z);
+    // The autoscale window is the part of each graph that is kept
+    valueAutoscale->setWindow(maxDataPoints);
 
-    ui->customplot->rescaleAxes(true);
-    ui->customplot->replot();
-    ui->customplot->update();
+    for(DevicePlot &plot : devicePlots)
+    {
+        this->appendGraphData(plot.graph_x,plot.newData_x,maxDataPoints);
+        this->appendGraphData(plot.graph_y,plot.newData_y,maxDataPoints);
+        this->appendGraphData(plot.graph_z,plot.newData_z,maxDataPoints);
+
+        plot.newData_x.clear();
+        plot.newData_y.clear();
+        plot.newData_z.clear();
+
+        plot.graph_x->setVisible(en_x);
+        plot.graph_y->setVisible(en_y);
+        plot.graph_z->setVisible(en_z);
+    }
+
+    // The key range is cached by the data containers, the value range comes from the sliding window
+    ui->customplot->xAxis->rescale(true);
+    valueAutoscale->apply();
 }
 
 void MainWindow::convertAndPlot()
@@ -300,19 +508,23 @@ void MainWindow::convertAndPlot()
     }
 
     this->updatePlot();
+    ui->customplot->replotData();
 }
 
 
 
 void MainWindow::on_clearPlotButton_clicked()
 {
-    ui->customplot->graph(0)->data()->clear();
-    ui->customplot->graph(1)->data()->clear();
-    ui->customplot->graph(2)->data()->clear();
-
-    plotDataValues_x.clear();
-    plotDataValues_y.clear();
-    plotDataValues_z.clear();
+    for(int i=0;i<ui->customplot->graphCount();i++)
+    {
+        QCPGraph *graph = ui->customplot->graph(i);
+        graph->data()->clear();
+        if(graph->columns())
+        {
+            graph->columns()->clear();
+        }
+    }
+    valueAutoscale->clear();
 
     ui->customplot->replot();
     ui->customplot->update();
@@ -331,8 +543,14 @@ void MainWindow::on_save_to_file_button_clicked()
     QString DataFileName = ui->edit_file_name->text();
     QString DataFileNumber = ui->file_counter->text();
 
+    // x, y and z of every device one after another
     QVector<double> allData;
-    allData << plotDataValues_x << plotDataValues_y << plotDataValues_z;
+    for(const DevicePlot &plot : devicePlots)
+    {
+        allData << graphValues(plot.graph_x)
+                << graphValues(plot.graph_y)
+                << graphValues(plot.graph_z);
+    }
     this->saveQVectorToFile(allData,DataFolder+"/"+DataFileName+DataFileNumber+".acc");
 
     ui->file_counter->setValue(ui->file_counter->value()+1);
@@ -359,44 +577,42 @@ void MainWindow::on_set_folder_button_clicked()
 {
     //QString filter = "All Files (*.*) ;; Acceleration Files (*.acc) ;; Data Files(*.dat) ;; Binary Files (*.bin)";;
     DataFolder = QFileDialog::getExistingDirectory(this,"Open a folder","/Users/davidlohuis/Documents/Projekte/Projekt-Nocken/Projekt-Bluetoothnocken/Data");
-    ui->console->appendPlainText(DataFolder);
+    writeToConsole(DataFolder);
 }
 
 
 void MainWindow::on_get_folder_button_clicked()
 {
-    ui->console->appendPlainText(DataFolder);
+    writeToConsole(DataFolder);
 }
 
 
 void MainWindow::on_Run_Measure_stateChanged(int arg1)
 {
-    if(device->getCharState())
+    if(deviceManager->anyTXReady())
     {
         if(arg1)
         {
 
-            // Pipe Data to different array
-            disconnect(device,&Device::sendRXValue,this,&MainWindow::receiveRXValue);
-            connect(device,&Device::sendRXValue,this,&MainWindow::receiveRXValueToInt);
+            // Let the devices decode the data into their sample rings
+            deviceManager->setRXDecoding(true);
 
             // Send start command
             QString start = "Live";
-            device->writeToTXCharacteristic(start);
+            emit sendTXMessage(start);
 
             // Start the update plot function
-            //updatePlot_timer.start();
+            renderScheduler->start();
 
         }
         else
         {
             // Pipe Data back to the console
-            connect(device,&Device::sendRXValue,this,&MainWindow::receiveRXValue);
-            disconnect(device,&Device::sendRXValue,this,&MainWindow::receiveRXValueToInt);
+            deviceManager->setRXDecoding(false);
 
             QString end = "Stop";
-            device->writeToTXCharacteristic(end);
-            //updatePlot_timer.stop();
+            emit sendTXMessage(end);
+            renderScheduler->stop();
         }
     }
     else
@@ -409,41 +625,89 @@ void MainWindow::on_Run_Measure_stateChanged(int arg1)
 
 void MainWindow::on_get_single_point_clicked()
 {
-    qDebug() << value_length;
+    qDebug().noquote() << pipelineReport();
     //this->convertRawToIntData();
 }
 
+QString MainWindow::pipelineReport() const
+{
+    QStringList lines;
+    for(int i=0;i<deviceManager->count();i++)
+    {
+        const Device *d = deviceManager->device(i);
+        Device::RxStatistics stats = d->rxStatistics();
+        lines << QString("Device %1: RX notifications: %2 bytes: %3 samples: %4 overruns: %5"
+                         " decode failures: %6 sequence gaps: %7 lost: %8 reordered: %9")
+                 .arg(i+1)
+                 .arg(stats.notifications)
+                 .arg(stats.bytes)
+                 .arg(stats.samples)
+                 .arg(stats.overruns)
+                 .arg(stats.decodeFailures)
+                 .arg(stats.sequenceGaps)
+                 .arg(stats.lostNotifications)
+                 .arg(stats.reorderedNotifications);
+
+        auto simulated = qobject_cast<const SimulatedPeripheral *>(d->transport());
+        if(simulated)
+        {
+            lines << QString("Device %1: simulated packets: %2 dropped: %3 reconnects: %4")
+                     .arg(i+1)
+                     .arg(simulated->packetsSent())
+                     .arg(simulated->packetsDropped())
+                     .arg(simulated->reconnects());
+        }
+    }
+    lines << QString("Frames rendered: %1 idle: %2 skipped: %3 over budget: %4 updates coalesced: %5")
+             .arg(renderScheduler->framesRendered())
+             .arg(renderScheduler->framesIdle())
+             .arg(renderScheduler->framesSkipped())
+             .arg(renderScheduler->framesOverBudget())
+             .arg(renderScheduler->updatesCoalesced());
+    // The Replot row is the frame time
+    lines << latencyMonitor->summary();
+    return lines.join("\n");
+}
+
+void MainWindow::setRasterRendering(bool enabled)
+{
+    ui->rasterBox->setChecked(enabled);
+}
+
+void MainWindow::setKeepHistory(bool keep)
+{
+    ui->Dis_max_data->setChecked(keep);
+}
+
 
 
 
 void MainWindow::on_get_Data_stateChanged(int arg1)
 {
-    if(device->getCharState())
+    if(deviceManager->anyTXReady())
     {
         if(arg1)
         {
 
-            // Pipe Data to different array
-            disconnect(device,&Device::sendRXValue,this,&MainWindow::receiveRXValue);
-            connect(device,&Device::sendRXValue,this,&MainWindow::receiveRXValueToInt);
+            // Let the devices decode the data into their sample rings
+            deviceManager->setRXDecoding(true);
 
             // Send start command
             QString start = "Data";
-            device->writeToTXCharacteristic(start);
+            emit sendTXMessage(start);
 
             // Start the update plot function
-            //updatePlot_timer.start();
+            renderScheduler->start();
 
         }
         else
         {
             // Pipe Data back to the console
-            connect(device,&Device::sendRXValue,this,&MainWindow::receiveRXValue);
-            disconnect(device,&Device::sendRXValue,this,&MainWindow::receiveRXValueToInt);
+            deviceManager->setRXDecoding(false);
 
             QString end = "Stop";
-            device->writeToTXCharacteristic(end);
-            //updatePlot_timer.stop();
+            emit sendTXMessage(end);
+            renderScheduler->stop();
         }
     }
     else
@@ -452,3 +716,193 @@ void MainWindow::on_get_Data_stateChanged(int arg1)
     }
 }
 
+
+void MainWindow::on_frameRateBox_currentIndexChanged(int index)
+{
+    // 0: 30 Hz, 1: 60 Hz, 2: follow the screen refresh rate
+    if(index==2)
+    {
+        renderScheduler->setFrameMode(RenderScheduler::VSync);
+    }
+    else
+    {
+        renderScheduler->setFrameMode(RenderScheduler::FixedRate);
+        renderScheduler->setFrameRate(index==1 ? 60 : 30);
+    }
+}
+
+
+void MainWindow::on_decoderBox_currentTextChanged(const QString &name)
+{
+    deviceManager->setPacketDecoder(name);
+}
+
+void MainWindow::on_batchDecodeBox_toggled(bool checked)
+{
+    // Unpack every sample frame of a notification instead of the first one only
+    deviceManager->setBatchDecoding(checked);
+}
+
+void MainWindow::on_addDeviceButton_clicked()
+{
+    // The combo boxes now set up the new device, the others keep streaming
+    setActiveDevice(deviceManager->addDevice());
+    refreshDeviceList();
+    refreshServiceUUID();
+    refreshCharacteristicsUUID();
+    writeToConsole(QString("Device %1 added, search and select it").arg(deviceManager->count()));
+}
+
+void MainWindow::on_recordBox_toggled(bool checked)
+{
+    CaptureRecorder *recorder = deviceManager->recorder();
+    if(!checked)
+    {
+        recorder->stop();
+        writeToConsole(QString("Recording stopped, %1 samples written, %2 dropped")
+                       .arg(recorder->samplesWritten())
+                       .arg(recorder->samplesDropped()));
+        if(!recorder->errorString().isEmpty())
+        {
+            writeToConsole("Failed to write "+recorder->filePath()+": "+recorder->errorString());
+        }
+        return;
+    }
+
+    // Every decoded sample goes to disk while the box is checked
+    QString DataFileName = ui->edit_file_name->text();
+    QString DataFileNumber = ui->file_counter->text();
+    QString filePath = DataFolder+"/"+DataFileName+DataFileNumber+".acc";
+
+    if(recorder->start(filePath))
+    {
+        writeToConsole("Recording to "+filePath);
+        ui->file_counter->setValue(ui->file_counter->value()+1);
+    }
+    else
+    {
+        writeToConsole("Failed to open "+filePath+": "+recorder->errorString());
+        ui->recordBox->setChecked(false);
+    }
+}
+
+double MainWindow::replaySpeed() const
+{
+    // 0: real time, 1: 2x, 2: 10x, 3: as fast as the plot drains the samples
+    static const double speeds[] = {1,2,10,0};
+    int index = qBound(0,ui->replaySpeedBox->currentIndex(),3);
+    return speeds[index];
+}
+
+void MainWindow::on_openReplayButton_clicked()
+{
+    QString filePath = QFileDialog::getOpenFileName(this,"Open a recording",DataFolder,"Recordings (*.acc)");
+    if(filePath.isEmpty())
+    {
+        return;
+    }
+
+    QString error;
+    ReplaySource *replay = deviceManager->openReplay(filePath,&error);
+    if(!replay)
+    {
+        writeToConsole("Failed to open "+filePath+": "+error);
+        return;
+    }
+
+    replay->setSpeed(replaySpeed());
+    deviceManager->startReplay(replay);
+    renderScheduler->start();
+}
+
+void MainWindow::on_replaySpeedBox_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    for(ReplaySource *replay : deviceManager->replays())
+    {
+        replay->setSpeed(replaySpeed());
+    }
+}
+
+void MainWindow::startSimulation(SimulatedPeripheral::Settings settings)
+{
+    settings.autoStart = true;
+    deviceManager->setRXDecoding(true);
+    // The simulated packets carry a counter, so dropped notifications show up as gaps
+    ui->sequenceBox->setChecked(true);
+    // Every frame of a packet is decoded and plotted, otherwise the load test only sees the first
+    ui->batchDecodeBox->setChecked(true);
+    deviceManager->setBatchDecoding(true);
+    ui->sampleRateBox->setValue(settings.notificationRate*settings.framesPerPacket);
+    deviceManager->addDevice(new SimulatedPeripheral(settings));
+    renderScheduler->start();
+}
+
+void MainWindow::on_addSimulatedButton_clicked()
+{
+    // Behaves like a connected device, Run Measure starts and stops it
+    SimulatedPeripheral::Settings settings;
+    settings.notificationRate = 100;
+    settings.framesPerPacket = 10;
+    deviceManager->addDevice(new SimulatedPeripheral(settings));
+}
+
+void MainWindow::on_latencyBox_toggled(bool checked)
+{
+    // Start a fresh measurement every time the overlay is shown
+    if(checked)
+    {
+        latencyMonitor->reset();
+    }
+    latencyText->setVisible(checked);
+    updateLatencyOverlay();
+    ui->customplot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void MainWindow::on_exportLatencyButton_clicked()
+{
+    QString filePath = QFileDialog::getSaveFileName(this,"Export latency",DataFolder+"/latency.csv","CSV files (*.csv)");
+    if(filePath.isEmpty())
+    {
+        return;
+    }
+
+    if(latencyMonitor->exportCsv(filePath))
+    {
+        writeToConsole("Latency exported to "+filePath);
+    }
+    else
+    {
+        writeToConsole("Failed to write "+filePath);
+    }
+}
+
+void MainWindow::on_sequenceBox_toggled(bool checked)
+{
+    // Only meaningful if the peripheral puts a packet counter into the header byte
+    deviceManager->setSequenceChecking(checked);
+}
+
+void MainWindow::on_sampleRateBox_valueChanged(double hz)
+{
+    // 0 shows "Arrival time" and stamps the samples when their packet arrives
+    deviceManager->setNominalSampleRate(hz);
+    // The history columns take the new key grid when they are cleared
+    for(int i=0;i<ui->customplot->graphCount();i++)
+    {
+        if(QSharedPointer<QCPGraphColumns> columns = ui->customplot->graph(i)->columns())
+        {
+            columns->setKeyStep(hz>0 ? 1.0/hz : 0);
+        }
+    }
+}
+
+void MainWindow::on_rasterBox_toggled(bool checked)
+{
+    // Dashed pens of further devices still go through QPainter
+    for(int i=0;i<ui->customplot->graphCount();i++)
+    {
+        ui->customplot->graph(i)->setRasterRendering(checked);
+    }
+    ui->customplot->replot(QCustomPlot::rpQueuedReplot);
+}
@@ -5,7 +5,14 @@
 #include <QFile>
 #include <QDataStream>
 #include <QTimer>
+#include "consolesink.h"
 #include "device.h"
+#include "devicemanager.h"
+#include "latencymonitor.h"
+#include "renderscheduler.h"
+#include "simulatedperipheral.h"
+#include "streamingautoscale.h"
+#include "qcustomplot.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -19,27 +26,65 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Adds a simulated device that streams right away and starts the plot, for load tests
+    void startSimulation(SimulatedPeripheral::Settings settings);
+    // Counters of the devices and of the render scheduler, and the latency per stage
+    QString pipelineReport() const;
+    // Draws the graphs with the software rasterizer of QCPGraph
+    void setRasterRendering(bool enabled);
+    // Plots the whole history instead of the newest max points
+    void setKeepHistory(bool keep);
+
 private:
     Ui::MainWindow *ui;
-    Device *device = new Device;
+    DeviceManager *deviceManager = nullptr;
+    // The device the combo boxes and buttons act on
+    Device *device = nullptr;
+    void setActiveDevice(Device *newDevice);
     void refreshDeviceList();
     void saveQVectorToFile(const QVector<double>& data, const QString& filePath);
     void convertRawToIntData();
 
     QByteArray rawData;
     QByteArray rawValue;
-    int value_length = 0;
 
+    QVector<RxSample> drainBuffer;
+    QVector<LatencyStamp> latencyBuffer;
 
-    int plotCNT = 0;
-    QVector<double> plotDataValues_x;
-    QVector<double> plotDataValues_y;
-    QVector<double> plotDataValues_z;
-    QVector<double> plotDataKeys;
+    // Graph set of one device or replayed source and its new points, streamed into the graphs once per frame
+    struct DevicePlot
+    {
+        SampleRing<RxSample> *ring = nullptr;
+        // Only devices stamp their packets
+        SampleRing<LatencyStamp> *latencyRing = nullptr;
+        QCPGraph *graph_x = nullptr;
+        QCPGraph *graph_y = nullptr;
+        QCPGraph *graph_z = nullptr;
+        QVector<QCPGraphData> newData_x;
+        QVector<QCPGraphData> newData_y;
+        QVector<QCPGraphData> newData_z;
+    };
+    QList<DevicePlot> devicePlots;
+    QCPGraph *addChannelGraph(const QString &name, const QColor &color, int deviceIndex);
+    void addPlot(SampleRing<RxSample> *ring, const QString &label, SampleRing<LatencyStamp> *latencyRing = nullptr);
+    double replaySpeed() const;
+    void appendGraphData(QCPGraph *graph, const QVector<QCPGraphData> &newData, int maxDataPoints);
+    QVector<double> graphValues(QCPGraph *graph) const;
     QString DataFolder = "/Users/davidlohuis/Documents/Projekte/Projekt-Nocken/Projekt-Bluetoothnocken/Data";
-    QTimer updatePlot_timer;
+    RenderScheduler *renderScheduler = nullptr;
+    LatencyMonitor *latencyMonitor = nullptr;
+    QCPItemText *latencyText = nullptr;
+    void updateLatencyOverlay();
+    ConsoleSink *consoleSink = nullptr;
+    StreamingAutoscale *valueAutoscale = nullptr;
+
+signals:
+    void sendTXMessage(const QString &message);
 
 private slots:
+    void addDevicePlot(Device *newDevice);
+    void addReplayPlots(ReplaySource *replay);
+    void showThroughput();
     void addDeviceNames(QString name);
     void writeToConsole(QString msg);
     void addServiceUUID(QString uuid);
@@ -47,7 +92,7 @@ private slots:
     void refreshServiceUUID();
     void refreshCharacteristicsUUID();
     void receiveRXValue(const QByteArray &value);
-    void receiveRXValueToInt(const QByteArray &value);
+    void drainSampleRing();
     void updatePlot();
 
     void on_searchButton_clicked();
@@ -65,5 +110,18 @@ private slots:
     void convertAndPlot();
     void on_get_single_point_clicked();
     void on_get_Data_stateChanged(int arg1);
+    void on_frameRateBox_currentIndexChanged(int index);
+    void on_decoderBox_currentTextChanged(const QString &name);
+    void on_batchDecodeBox_toggled(bool checked);
+    void on_addDeviceButton_clicked();
+    void on_recordBox_toggled(bool checked);
+    void on_openReplayButton_clicked();
+    void on_replaySpeedBox_currentIndexChanged(int index);
+    void on_addSimulatedButton_clicked();
+    void on_latencyBox_toggled(bool checked);
+    void on_exportLatencyButton_clicked();
+    void on_sequenceBox_toggled(bool checked);
+    void on_sampleRateBox_valueChanged(double hz);
+    void on_rasterBox_toggled(bool checked);
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,49 @@
+#include "packetdecoder.h"
+
+PacketDecoderRegistry::PacketDecoderRegistry()
+{
+    // The first layout is the default, it is the format of the original firmware
+    registerLayout<qint16, ByteOrder::BigEndian, 3>("int16 BE x/y/z");
+    registerLayout<qint16, ByteOrder::LittleEndian, 3>("int16 LE x/y/z");
+    registerLayout<Int24, ByteOrder::BigEndian, 3>("int24 BE x/y/z");
+    registerLayout<Int24, ByteOrder::LittleEndian, 3>("int24 LE x/y/z");
+    registerLayout<float, ByteOrder::BigEndian, 3>("float32 BE x/y/z");
+    registerLayout<float, ByteOrder::LittleEndian, 3>("float32 LE x/y/z");
+    registerLayout<qint16, ByteOrder::BigEndian, 1>("int16 BE single channel");
+}
+
+PacketDecoderRegistry &PacketDecoderRegistry::instance()
+{
+    static PacketDecoderRegistry registry;
+    return registry;
+}
+
+void PacketDecoderRegistry::registerDecoder(PacketDecoder *decoder)
+{
+    std::unique_ptr<const PacketDecoder> entry(decoder);
+    if (!entry || this->decoder(entry->name()))
+        return;
+    m_decoders.push_back(std::move(entry));
+}
+
+const PacketDecoder *PacketDecoderRegistry::decoder(const QString &name) const
+{
+    for (const auto &d : m_decoders) {
+        if (d->name() == name)
+            return d.get();
+    }
+    return nullptr;
+}
+
+const PacketDecoder *PacketDecoderRegistry::defaultDecoder() const
+{
+    return m_decoders.empty() ? nullptr : m_decoders.front().get();
+}
+
+QStringList PacketDecoderRegistry::names() const
+{
+    QStringList result;
+    for (const auto &d : m_decoders)
+        result.append(d->name());
+    return result;
+}
@@ -0,0 +1,188 @@
+#ifndef PACKETDECODER_H
+#define PACKETDECODER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "samplering.h"
+#include "rxkernels.h"
+
+enum class ByteOrder { BigEndian, LittleEndian };
+
+// Tag type for packed 24 bit signed integers
+struct Int24 {};
+
+// Reads one value of the given sample type from raw packet bytes
+template <typename SampleType, ByteOrder Order>
+struct SampleFormat;
+
+template <ByteOrder Order>
+struct SampleFormat<qint16, Order>
+{
+    static constexpr int Size = 2;
+    static double load(const uchar *p)
+    {
+        if (Order == ByteOrder::BigEndian)
+            return qint16((p[0] << 8) | p[1]);
+        return qint16((p[1] << 8) | p[0]);
+    }
+};
+
+template <ByteOrder Order>
+struct SampleFormat<Int24, Order>
+{
+    static constexpr int Size = 3;
+    static double load(const uchar *p)
+    {
+        quint32 raw;
+        if (Order == ByteOrder::BigEndian)
+            raw = (quint32(p[0]) << 16) | (quint32(p[1]) << 8) | p[2];
+        else
+            raw = (quint32(p[2]) << 16) | (quint32(p[1]) << 8) | p[0];
+        // Sign extend from 24 to 32 bit
+        return qint32(raw << 8) >> 8;
+    }
+};
+
+template <ByteOrder Order>
+struct SampleFormat<float, Order>
+{
+    static constexpr int Size = 4;
+    static double load(const uchar *p)
+    {
+        quint32 raw;
+        if (Order == ByteOrder::BigEndian)
+            raw = (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | p[3];
+        else
+            raw = (quint32(p[3]) << 24) | (quint32(p[2]) << 16) | (quint32(p[1]) << 8) | p[0];
+        float value;
+        std::memcpy(&value, &raw, sizeof(value));
+        return value;
+    }
+};
+
+// Interface of all packet layouts. Decoders are stateless and may be shared between threads.
+class PacketDecoder
+{
+public:
+    virtual ~PacketDecoder() = default;
+
+    virtual QString name() const = 0;
+    virtual int channelCount() const = 0;
+    virtual int frameSize() const = 0;
+    virtual int headerSize() const = 0;
+    virtual int minimumPacketSize() const = 0;
+
+    // The first header byte, a counter that wraps at 256, or -1 if the layout has no header
+    int sequenceNumber(const QByteArray &packet) const
+    {
+        if (headerSize() <= 0 || packet.isEmpty())
+            return -1;
+        return uchar(packet.at(0));
+    }
+
+    // Number of complete sample frames in a packet of the given size
+    virtual int frameCount(int packetSize) const = 0;
+
+    // Decodes up to maxSamples frames of the packet into out and returns the number
+    // of samples written, or -1 if the packet does not match the layout.
+    // Pass maxSamples=1 to only take the first frame. The keys are left untouched.
+    virtual int decode(const QByteArray &packet, RxSample *out, int maxSamples) const = 0;
+};
+
+// Packet layout specialized at compile time: HeaderBytes are skipped, then
+// each frame holds Channels values of SampleType in the given byte order.
+// Channels beyond x/y/z are read over but not plotted.
+template <typename SampleType, ByteOrder Order, int Channels, int HeaderBytes = 1>
+class PacketLayout: public PacketDecoder
+{
+    static_assert(Channels > 0, "A packet layout needs at least one channel");
+    using Format = SampleFormat<SampleType, Order>;
+
+public:
+    explicit PacketLayout(const QString &name) : m_name(name) {}
+
+    QString name() const override { return m_name; }
+    int channelCount() const override { return Channels; }
+    int frameSize() const override { return Channels*Format::Size; }
+    int headerSize() const override { return HeaderBytes; }
+    int minimumPacketSize() const override { return HeaderBytes + frameSize(); }
+
+    int frameCount(int packetSize) const override
+    {
+        return packetSize < HeaderBytes ? 0 : (packetSize - HeaderBytes)/(Channels*Format::Size);
+    }
+
+    int decode(const QByteArray &packet, RxSample *out, int maxSamples) const override
+    {
+        if (packet.size() < minimumPacketSize())
+            return -1;
+
+        // Read straight from the packet bytes, the frames follow the header back to back.
+        // The stride is a compile time constant, so the loop can be vectorized.
+        const int n = qMin(frameCount(packet.size()), maxSamples);
+        const uchar *frame = reinterpret_cast<const uchar *>(packet.constData()) + HeaderBytes;
+
+        // Big endian int16 x/y/z goes through the SIMD kernel in cache sized chunks
+        if constexpr (std::is_same<SampleType, qint16>::value && Order == ByteOrder::BigEndian && Channels == 3) {
+            if (n > 1) {
+                double x[64], y[64], z[64];
+                for (int done = 0; done < n; done += 64) {
+                    const int chunk = qMin(n - done, 64);
+                    RxKernels::int16BEToChannels(frame + done*6, chunk, x, y, z);
+                    for (int i = 0; i < chunk; i++) {
+                        out[done + i].x = x[i];
+                        out[done + i].y = y[i];
+                        out[done + i].z = z[i];
+                    }
+                }
+                return n;
+            }
+        }
+
+        for (int i = 0; i < n; i++)
+            decodeFrame(frame + i*Channels*Format::Size, out[i]);
+        return qMax(n, 0);
+    }
+
+    static void decodeFrame(const uchar *frame, RxSample &sample)
+    {
+        sample.x = Format::load(frame);
+        sample.y = Channels > 1 ? Format::load(frame + Format::Size) : 0;
+        sample.z = Channels > 2 ? Format::load(frame + 2*Format::Size) : 0;
+    }
+
+private:
+    QString m_name;
+};
+
+// Holds all known packet layouts, looked up by name
+class PacketDecoderRegistry
+{
+public:
+    static PacketDecoderRegistry &instance();
+
+    // Takes ownership of the decoder. Decoders are never removed, so the returned
+    // pointers stay valid; a second decoder with an existing name is discarded.
+    void registerDecoder(PacketDecoder *decoder);
+
+    template <typename SampleType, ByteOrder Order, int Channels, int HeaderBytes = 1>
+    void registerLayout(const QString &name)
+    {
+        registerDecoder(new PacketLayout<SampleType, Order, Channels, HeaderBytes>(name));
+    }
+
+    const PacketDecoder *decoder(const QString &name) const;
+    const PacketDecoder *defaultDecoder() const;
+    QStringList names() const;
+
+private:
+    PacketDecoderRegistry();
+    std::vector<std::unique_ptr<const PacketDecoder>> m_decoders;
+};
+
+#endif // PACKETDECODER_H
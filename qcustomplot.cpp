@@ -10641,7 +10641,9 @@ QCPScatterStyle::QCPScatterStyle() :
   mShape(ssNone),
   mPen(Qt::NoPen),
   mBrush(Qt::NoBrush),
-  mPenDefined(false)
+  mPenDefined(false),
+  mStampRatio(0),
+  mStampAntialiased(false)
 {
 }
 
@@ -10657,7 +10659,9 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, double size) :
   mShape(shape),
   mPen(Qt::NoPen),
   mBrush(Qt::NoBrush),
-  mPenDefined(false)
+  mPenDefined(false),
+  mStampRatio(0),
+  mStampAntialiased(false)
 {
 }
 
@@ -10670,7 +10674,9 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, const QColor &color, double
   mShape(shape),
   mPen(QPen(color)),
   mBrush(Qt::NoBrush),
-  mPenDefined(true)
+  mPenDefined(true),
+  mStampRatio(0),
+  mStampAntialiased(false)
 {
 }
 
@@ -10683,7 +10689,9 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, const QColor &color, const
   mShape(shape),
   mPen(QPen(color)),
   mBrush(QBrush(fill)),
-  mPenDefined(true)
+  mPenDefined(true),
+  mStampRatio(0),
+  mStampAntialiased(false)
 {
 }
 
@@ -10707,7 +10715,9 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, const QPen &pen, const QBru
   mShape(shape),
   mPen(pen),
   mBrush(brush),
-  mPenDefined(pen.style() != Qt::NoPen)
+  mPenDefined(pen.style() != Qt::NoPen),
+  mStampRatio(0),
+  mStampAntialiased(false)
 {
 }
 
@@ -10721,7 +10731,9 @@ QCPScatterStyle::QCPScatterStyle(const QPixmap &pixmap) :
   mPen(Qt::NoPen),
   mBrush(Qt::NoBrush),
   mPixmap(pixmap),
-  mPenDefined(false)
+  mPenDefined(false),
+  mStampRatio(0),
+  mStampAntialiased(false)
 {
 }
 
@@ -10740,7 +10752,9 @@ QCPScatterStyle::QCPScatterStyle(const QPainterPath &customPath, const QPen &pen
   mPen(pen),
   mBrush(brush),
   mCustomPath(customPath),
-  mPenDefined(pen.style() != Qt::NoPen)
+  mPenDefined(pen.style() != Qt::NoPen),
+  mStampRatio(0),
+  mStampAntialiased(false)
 {
 }
 
@@ -10777,6 +10791,7 @@ void QCPScatterStyle::setFromOther(const QCPScatterStyle &other, ScatterProperti
 void QCPScatterStyle::setSize(double size)
 {
   mSize = size;
+  mStamp = QImage();
 }
 
 /*!
@@ -10790,6 +10805,7 @@ void QCPScatterStyle::setSize(double size)
 void QCPScatterStyle::setShape(QCPScatterStyle::ScatterShape shape)
 {
   mShape = shape;
+  mStamp = QImage();
 }
 
 /*!
@@ -10874,6 +10890,12 @@ void QCPScatterStyle::applyTo(QCPPainter *painter, const QPen &defaultPen) const
   This function does not modify the pen or the brush on the painter, as \ref applyTo is meant to be
   called before scatter points are drawn with \ref drawShape.
   
+  When painting to a pixel based device, the shape is rendered once into an image for the current
+  pen, brush, device pixel ratio and antialiasing of \a painter (see \ref stamp) and that image is
+  drawn at each position. For vectorized output (e.g. PDF export) and other exports (\ref
+  QCPPainter::pmNoCaching), and for painters with a scaling or rotating transform, the shape is
+  drawn with vector operations.
+  
   \see applyTo
 */
 void QCPScatterStyle::drawShape(QCPPainter *painter, const QPointF &pos) const
@@ -10885,6 +10907,95 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, const QPointF &pos) const
   Draws the scatter shape with \a painter at position \a x and \a y.
 */
 void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
+{
+  if (canUseStamp(painter))
+  {
+    const double ratio = painter->device()->devicePixelRatioF();
+    const QImage image = stamp(painter->pen(), painter->brush(), ratio, painter->antialiasing());
+    if (!image.isNull())
+    {
+      const double halfSide = image.width()*0.5/ratio;
+      painter->drawImage(QPointF(x-halfSide, y-halfSide), image);
+      return;
+    }
+  }
+  drawVectorShape(painter, x, y);
+}
+
+/*!
+  Returns an image of the scatter shape drawn with \a pen and \a brush, centered in the image, at
+  \a devicePixelRatio (the image has that device pixel ratio set) and with or without antialiasing.
+  The image is in QImage::Format_ARGB32_Premultiplied.
+  
+  Images are kept in a cache shared by all scatter styles, so every combination of shape, size,
+  pen, brush, device pixel ratio and antialiasing is rendered only once. Additionally, this
+  instance remembers the last image it returned, so repeated calls with the same arguments are
+  cheap.
+  
+  Returns a null image for \ref ssNone, \ref ssPixmap and \ref ssCustom, and for pens or brushes
+  that aren't solid colors (gradients and patterns depend on the position on the device).
+*/
+QImage QCPScatterStyle::stamp(const QPen &pen, const QBrush &brush, double devicePixelRatio, bool antialiased) const
+{
+  if (mShape == ssNone || mShape == ssPixmap || mShape == ssCustom)
+    return QImage();
+  if ((pen.style() != Qt::NoPen && pen.brush().style() != Qt::SolidPattern) || (brush.style() != Qt::NoBrush && brush.style() != Qt::SolidPattern))
+    return QImage();
+  if (!mStamp.isNull() && mStampRatio == devicePixelRatio && mStampAntialiased == antialiased && mStampPen == pen && mStampBrush == brush)
+    return mStamp;
+  
+  static QCache<QString, QImage> stampCache(256);
+  const QString key = QString("%1|%2|%3|%4|%5|%6|%7|%8|%9|%10")
+      .arg(int(mShape)).arg(mSize)
+      .arg(int(pen.style())).arg(pen.color().rgba()).arg(pen.widthF()).arg(int(pen.capStyle())*256+int(pen.joinStyle())*2+(pen.isCosmetic() ? 1 : 0))
+      .arg(int(brush.style())).arg(brush.color().rgba())
+      .arg(devicePixelRatio).arg(antialiased ? 1 : 0);
+  if (QImage *cached = stampCache.object(key))
+  {
+    mStamp = *cached;
+  } else
+  {
+    const double penWidth = pen.style() == Qt::NoPen ? 0 : qMax(1.0, pen.widthF());
+    const int side = qCeil((mSize+penWidth+2)*devicePixelRatio);
+    QImage image(side, side, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    image.fill(Qt::transparent);
+    {
+      QCPPainter painter(&image);
+      painter.setAntialiasing(antialiased);
+      painter.setPen(pen);
+      painter.setBrush(brush);
+      const double center = side*0.5/devicePixelRatio-(antialiased ? 0.5 : 0); // setAntialiasing shifted the painter by half a pixel
+      drawVectorShape(&painter, center, center);
+    }
+    stampCache.insert(key, new QImage(image));
+    mStamp = image;
+  }
+  mStampPen = pen;
+  mStampBrush = brush;
+  mStampRatio = devicePixelRatio;
+  mStampAntialiased = antialiased;
+  return mStamp;
+}
+
+/*! \internal
+
+  Returns whether \ref drawShape may draw the cached image of the shape with \a painter.
+*/
+bool QCPScatterStyle::canUseStamp(QCPPainter *painter) const
+{
+  return mShape != ssNone && mShape != ssPixmap && mShape != ssCustom &&
+      !painter->modes().testFlag(QCPPainter::pmVectorized) &&
+      !painter->modes().testFlag(QCPPainter::pmNoCaching) &&
+      painter->device() &&
+      painter->transform().type() <= QTransform::TxTranslate;
+}
+
+/*! \internal
+
+  Draws the scatter shape with vector operations of \a painter at position \a x and \a y.
+*/
+void QCPScatterStyle::drawVectorShape(QCPPainter *painter, double x, double y) const
 {
   double w = mSize/2.0;
   switch (mShape)
@@ -13618,11 +13729,13 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mSelectionRectMode(QCP::srmNone),
   mSelectionRect(nullptr),
   mOpenGl(false),
+  mStreamingMode(false),
   mMouseHasMoved(false),
   mMouseEventLayerable(nullptr),
   mMouseSignalLayerable(nullptr),
   mReplotting(false),
   mReplotQueued(false),
+  mDataReplotQueued(false),
   mReplotTime(0),
   mReplotTimeAverage(0),
   mOpenGlMultisamples(16),
@@ -14101,6 +14214,45 @@ void QCustomPlot::setOpenGl(bool enabled, int multisampling)
 #endif
 }
 
+/*!
+  Sets whether the plot is in streaming mode. In streaming mode, all plottables are put on a
+  separate layer called "streaming" with mode \ref QCPLayer::lmBuffered, directly above the "main"
+  layer. Plottables added later are moved there as well. The layer is available as \ref
+  streamingLayer.
+  
+  Since the plottables then have their own paint buffer, a refresh after new data arrived only needs
+  to redraw them, while axes, grid, legend and items keep their buffers until the axis ranges
+  change. Use \ref replotData instead of \ref replot for those data only refreshes.
+  
+  Disabling streaming mode removes the "streaming" layer, its plottables move to the layer below
+  (usually "main").
+  
+  \see replotData
+*/
+void QCustomPlot::setStreamingMode(bool enabled)
+{
+  if (mStreamingMode == enabled)
+    return;
+  mStreamingMode = enabled;
+  if (enabled)
+  {
+    if (!mStreamingLayer)
+    {
+      if (!layer(QLatin1String("streaming")))
+        addLayer(QLatin1String("streaming"), layer(QLatin1String("main")), limAbove);
+      mStreamingLayer = layer(QLatin1String("streaming"));
+    }
+    mStreamingLayer->setMode(QCPLayer::lmBuffered);
+    foreach (QCPAbstractPlottable *plottable, mPlottables)
+      plottable->setLayer(mStreamingLayer.data());
+  } else if (mStreamingLayer)
+  {
+    removeLayer(mStreamingLayer.data());
+    mStreamingLayer = nullptr;
+  }
+  mStreamingRanges.clear(); // next replotData does a complete replot
+}
+
 /*!
   Sets the viewport of this QCustomPlot. Usually users of QCustomPlot don't need to change the
   viewport manually.
@@ -15149,20 +15301,93 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   foreach (QSharedPointer<QCPAbstractPaintBuffer> buffer, mPaintBuffers)
     buffer->setInvalidated(false);
   
+  // remember what the static layers show, so replotData can tell whether they are still valid:
+  if (mStreamingMode)
+  {
+    mStreamingViewport = mViewport;
+    mStreamingRanges = axisRanges();
+  }
+  
   if ((refreshPriority == rpRefreshHint && mPlottingHints.testFlag(QCP::phImmediateRefresh)) || refreshPriority==rpImmediateRefresh)
     repaint();
   else
     update();
   
 # if QT_VERSION < QT_VERSION_CHECK(4, 8, 0)
-  mReplotTime = replotTimer.elapsed();
+  updateReplotTime(replotTimer.elapsed());
 # else
-  mReplotTime = replotTimer.nsecsElapsed()*1e-6;
+  updateReplotTime(replotTimer.nsecsElapsed()*1e-6);
+# endif
+  
+  emit afterReplot();
+  mReplotting = false;
+}
+
+/*!
+  Refreshes only the plottables, if the plot is in streaming mode (\ref setStreamingMode) and
+  nothing but the data of the plottables changed since the last \ref replot. Otherwise a complete
+  replot is performed, see \ref replot.
+  
+  In streaming mode all plottables are on the buffered \ref streamingLayer. If the viewport and the
+  ranges of all axes are the same as in the last complete replot, the static layers (background,
+  grid, axes, legend, items on the "main" layer,...) are still valid, and only the streaming layer
+  is redrawn with \ref QCPLayer::replot. This is what a scrolling live plot needs for every new
+  batch of samples as long as the axis ranges stay put.
+  
+  Changes to anything but axis ranges and data (e.g. axis labels, tick settings, item positions,
+  selections) are not detected. Call \ref replot after such changes.
+  
+  The signals \ref beforeReplot and \ref afterReplot are emitted for data only refreshes as well,
+  and \ref replotTime includes them.
+  
+  \a refreshPriority has the same meaning as for \ref replot. With \ref rpQueuedReplot, the data
+  refresh is skipped if a complete replot is already queued.
+*/
+void QCustomPlot::replotData(QCustomPlot::RefreshPriority refreshPriority)
+{
+  if (!mStreamingMode || !mStreamingLayer)
+  {
+    replot(refreshPriority);
+    return;
+  }
+  if (refreshPriority == QCustomPlot::rpQueuedReplot)
+  {
+    if (!mDataReplotQueued && !mReplotQueued)
+    {
+      mDataReplotQueued = true;
+      QTimer::singleShot(0, this, SLOT(replotData()));
+    }
+    return;
+  }
+  
+  mDataReplotQueued = false;
+  if (mReplotting) // incase signals loop back to replot slot
+    return;
+  if (mStreamingLayer->mode() != QCPLayer::lmBuffered || mViewport != mStreamingViewport || axisRanges() != mStreamingRanges || hasInvalidatedPaintBuffers())
+  {
+    replot(refreshPriority);
+    return;
+  }
+  mReplotting = true;
+  emit beforeReplot();
+  
+# if QT_VERSION < QT_VERSION_CHECK(4, 8, 0)
+  QTime replotTimer;
+  replotTimer.start();
+# else
+  QElapsedTimer replotTimer;
+  replotTimer.start();
+# endif
+  
+  mStreamingLayer->replot();
+  if ((refreshPriority == rpRefreshHint && mPlottingHints.testFlag(QCP::phImmediateRefresh)) || refreshPriority==rpImmediateRefresh)
+    repaint();
+  
+# if QT_VERSION < QT_VERSION_CHECK(4, 8, 0)
+  updateReplotTime(replotTimer.elapsed());
+# else
+  updateReplotTime(replotTimer.nsecsElapsed()*1e-6);
 # endif
-  if (!qFuzzyIsNull(mReplotTimeAverage))
-    mReplotTimeAverage = mReplotTimeAverage*0.9 + mReplotTime*0.1; // exponential moving average with a time constant of 10 last replots
-  else
-    mReplotTimeAverage = mReplotTime; // no previous replots to average with, so initialize with replot time
   
   emit afterReplot();
   mReplotting = false;
@@ -15919,6 +16144,36 @@ bool QCustomPlot::hasInvalidatedPaintBuffers()
   return false;
 }
 
+/*! \internal
+
+  Returns the ranges of all axes of all axis rects, used by \ref replotData to detect whether the
+  static layers need to be redrawn.
+*/
+QVector<QCPRange> QCustomPlot::axisRanges() const
+{
+  QVector<QCPRange> result;
+  foreach (QCPAxisRect *rect, axisRects())
+  {
+    foreach (QCPAxis *axis, rect->axes())
+      result.append(axis->range());
+  }
+  return result;
+}
+
+/*! \internal
+
+  Sets the time of the last replot to \a milliseconds and updates the moving average, see \ref
+  replotTime.
+*/
+void QCustomPlot::updateReplotTime(double milliseconds)
+{
+  mReplotTime = milliseconds;
+  if (!qFuzzyIsNull(mReplotTimeAverage))
+    mReplotTimeAverage = mReplotTimeAverage*0.9 + mReplotTime*0.1; // exponential moving average with a time constant of 10 last replots
+  else
+    mReplotTimeAverage = mReplotTime; // no previous replots to average with, so initialize with replot time
+}
+
 /*! \internal
 
   When \ref setOpenGl is set to true, this method is used to initialize OpenGL (create a context,
@@ -16229,6 +16484,8 @@ bool QCustomPlot::registerPlottable(QCPAbstractPlottable *plottable)
     plottable->addToLegend();
   if (!plottable->layer()) // usually the layer is already set in the constructor of the plottable (via QCPLayerable constructor)
     plottable->setLayer(currentLayer());
+  if (mStreamingMode && mStreamingLayer)
+    plottable->setLayer(mStreamingLayer.data());
   return true;
 }
 
@@ -20812,154 +21069,1393 @@ QCPGraphData::QCPGraphData(double key, double value) :
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPGraph
+//////////////////// QCPGraphLodPyramid
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPGraph
-  \brief A plottable representing a graph in a plot.
-
-  \image html QCPGraph.png
-  
-  Usually you create new graphs by calling QCustomPlot::addGraph. The resulting instance can be
-  accessed via QCustomPlot::graph.
+/*! \class QCPGraphLodPyramid
+  \brief Multi-resolution min/max summary of a QCPGraphDataContainer
 
-  To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
-  also access and modify the data via the \ref data method, which returns a pointer to the internal
-  \ref QCPGraphDataContainer.
-  
-  Graphs are used to display single-valued data. Single-valued means that there should only be one
-  data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
-  want to plot non-single-valued curves, rather use the QCPCurve plottable.
-  
-  Gaps in the graph line can be created by adding data points with NaN as value
-  (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
-  separated.
-  
-  \section qcpgraph-appearance Changing the appearance
-  
-  The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
-  of the graph (\ref setLineStyle, \ref setScatterStyle, \ref setBrush, \ref setPen).
-  
-  \subsection filling Filling under or between graphs
-  
-  QCPGraph knows two types of fills: Normal graph fills towards the zero-value-line parallel to
-  the key axis of the graph, and fills between two graphs, called channel fills. To enable a fill,
-  just set a brush with \ref setBrush which is neither Qt::NoBrush nor fully transparent.
-  
-  By default, a normal fill towards the zero-value-line will be drawn. To set up a channel fill
-  between this graph and another one, call \ref setChannelFillGraph with the other graph as
-  parameter.
+  The pyramid summarizes the data points of a graph in buckets: the buckets of level 0 hold \ref
+  BaseBucketSize consecutive points, every bucket of the next level combines four buckets of the
+  level below. Each bucket knows its key span, its first and last value and its value extremes.
 
-  \see QCustomPlot::addGraph, QCustomPlot::graph
-*/
+  \ref QCPGraph keeps one pyramid next to its data container and uses it in \ref
+  QCPGraph::getOptimizedLineData when many points fall on one pixel: instead of walking every
+  visible point, it walks the buckets of the coarsest level that is still finer than a pixel, so
+  the cost depends on the pixel width of the graph and not on the number of points.
 
-/* start of documentation of inline functions */
+  The pyramid is updated incrementally by \ref sync: points appended at the end are summarized,
+  points removed at the front (\ref QCPDataContainer::removeBefore) drop the buckets that only held
+  removed points. Any other modification of the container is detected by comparing the keys at the
+  seams and causes a complete rebuild. Values that are modified in place through the non-const
+  iterators are not detected, call \ref clear in that case.
 
-/*! \fn QSharedPointer<QCPGraphDataContainer> QCPGraph::data() const
-  
-  Returns a shared pointer to the internal data storage of type \ref QCPGraphDataContainer. You may
-  use it to directly manipulate the data, which may be more convenient and faster than using the
-  regular \ref setData or \ref addData methods.
+  Buckets at the front that lost some of their points keep their old summary. They are never used
+  for drawing, since only buckets that lie completely within the data are used.
 */
 
-/* end of documentation of inline functions */
+QCPGraphLodPyramid::QCPGraphLodPyramid() :
+  mAbsoluteBegin(0),
+  mAbsoluteEnd(0),
+  mFirstKey(0),
+  mLastKey(0)
+{
+}
 
 /*!
-  Constructs a graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value
-  axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not have
-  the same orientation. If either of these restrictions is violated, a corresponding message is
-  printed to the debug output (qDebug), the construction is not aborted, though.
-  
-  The created QCPGraph is automatically registered with the QCustomPlot instance inferred from \a
-  keyAxis. This QCustomPlot instance takes ownership of the QCPGraph, so do not delete it manually
-  but use QCustomPlot::removePlottable() instead.
-  
-  To directly create a graph inside a plot, you can also use the simpler QCustomPlot::addGraph function.
+  Removes all buckets. The next \ref sync rebuilds the pyramid.
 */
-QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
-  QCPAbstractPlottable1D<QCPGraphData>(keyAxis, valueAxis),
-  mLineStyle{},
-  mScatterSkip{},
-  mAdaptiveSampling{}
+void QCPGraphLodPyramid::clear()
 {
-  // special handling for QCPGraphs to maintain the simple graph interface:
-  mParentPlot->registerGraph(this);
-
-  setPen(QPen(Qt::blue, 0));
-  setBrush(Qt::NoBrush);
-  
-  setLineStyle(lsLine);
-  setScatterSkip(0);
-  setChannelFillGraph(nullptr);
-  setAdaptiveSampling(true);
+  mLevels.clear();
+  mFirstBucket.clear();
+  mAbsoluteBegin = 0;
+  mAbsoluteEnd = 0;
 }
 
-QCPGraph::~QCPGraph()
+/*!
+  Brings the pyramid up to date with \a data. Appended points cost O(1) amortized each, points
+  removed from the front cost O(1) amortized per bucket, everything else causes a rebuild.
+*/
+void QCPGraphLodPyramid::sync(const QCPGraphDataContainer &data)
 {
-}
-
-/*! \overload
-  
-  Replaces the current data container with the provided \a data container.
-  
-  Since a QSharedPointer is used, multiple QCPGraphs may share the same data container safely.
-  Modifying the data in the container will then affect all graphs that share the container. Sharing
-  can be achieved by simply exchanging the data containers wrapped in shared pointers:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-1
+  const int size = data.size();
+  if (size == 0)
+  {
+    clear();
+    return;
+  }
+  if (mAbsoluteEnd == mAbsoluteBegin)
+  {
+    rebuild(data);
+    return;
+  }
   
-  If you do not wish to share containers, but create a copy from an existing container, rather use
-  the \ref QCPDataContainer<DataType>::set method on the graph's data container directly:
-  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-2
+  // points were removed at the front, find how many by the first level 0 bucket that still has points:
+  const double firstKey = data.constBegin()->key;
+  if (firstKey != mFirstKey)
+  {
+    if (firstKey < mFirstKey)
+    {
+      rebuild(data);
+      return;
+    }
+    const std::deque<Bucket> &level0 = mLevels.at(0);
+    std::deque<Bucket>::const_iterator it = std::lower_bound(level0.begin(), level0.end(), firstKey, [](const Bucket &bucket, double key) { return bucket.lastKey < key; });
+    if (it == level0.end())
+    {
+      rebuild(data);
+      return;
+    }
+    const qint64 bucketIndex = mFirstBucket.at(0)+qint64(it-level0.begin());
+    const qint64 bucketEnd = qMin((bucketIndex+1)*BaseBucketSize, mAbsoluteEnd);
+    const qint64 survivors = qint64(data.findEnd(it->lastKey, false)-data.constBegin());
+    const qint64 newBegin = bucketEnd-survivors;
+    if (survivors < 1 || newBegin < mAbsoluteBegin || newBegin < bucketIndex*BaseBucketSize)
+    {
+      rebuild(data);
+      return;
+    }
+    dropBefore(newBegin);
+    mFirstKey = firstKey;
+  }
   
-  \see addData
-*/
-void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
-{
-  mDataContainer = data;
+  // everything summarized so far must still be in place, then only the tail is new:
+  const qint64 known = mAbsoluteEnd-mAbsoluteBegin;
+  if (known > size || data.at(int(known-1))->key != mLastKey)
+  {
+    rebuild(data);
+    return;
+  }
+  if (known < size)
+    append(data.constBegin()+int(known), data.constEnd());
 }
 
-/*! \overload
-  
-  Replaces the current data with the provided points in \a keys and \a values. The provided
-  vectors should have equal length. Else, the number of added points will be the size of the
-  smallest vector.
-  
-  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
-  can set \a alreadySorted to true, to improve performance by saving a sorting run.
-  
-  \see addData
+/*!
+  Returns the coarsest level whose buckets hold at most half of \a pointsPerPixel points, or -1 if
+  even level 0 is too coarse, in which case the points should be used directly.
 */
-void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+int QCPGraphLodPyramid::levelForPointsPerPixel(double pointsPerPixel) const
 {
-  mDataContainer->clear();
-  addData(keys, values, alreadySorted);
+  int level = -1;
+  while (level+1 < levelCount() && 2.0*bucketSize(level+1) <= pointsPerPixel)
+    ++level;
+  return level;
 }
 
 /*!
-  Sets how the single data points are connected in the plot. For scatter-only plots, set \a ls to
-  \ref lsNone and \ref setScatterStyle to the desired scatter style.
-  
-  \see setScatterStyle
+  Returns a level 0 style bucket that holds the single point \a point.
 */
-void QCPGraph::setLineStyle(LineStyle ls)
+QCPGraphLodPyramid::Bucket QCPGraphLodPyramid::pointBucket(const QCPGraphData &point)
 {
-  mLineStyle = ls;
+  Bucket bucket;
+  bucket.firstKey = bucket.lastKey = point.key;
+  bucket.firstValue = bucket.lastValue = point.value;
+  bucket.count = 1;
+  bucket.hasNan = qIsNaN(point.value);
+  if (bucket.hasNan)
+  {
+    bucket.minValue = (std::numeric_limits<double>::max)();
+    bucket.maxValue = std::numeric_limits<double>::lowest();
+  } else
+    bucket.minValue = bucket.maxValue = point.value;
+  return bucket;
 }
 
 /*!
-  Sets the visual appearance of single data points in the plot. If set to \ref QCPScatterStyle::ssNone, no scatter points
-  are drawn (e.g. for line-only-plots with appropriate line style).
-  
-  \see QCPScatterStyle, setLineStyle
+  Extends \a target by \a source, which must follow \a target in key order.
 */
-void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
+void QCPGraphLodPyramid::mergeBucket(Bucket &target, const Bucket &source)
 {
-  mScatterStyle = style;
+  target.lastKey = source.lastKey;
+  target.lastValue = source.lastValue;
+  if (source.minValue < target.minValue)
+    target.minValue = source.minValue;
+  if (source.maxValue > target.maxValue)
+    target.maxValue = source.maxValue;
+  target.count += source.count;
+  target.hasNan = target.hasNan || source.hasNan;
 }
 
-/*!
-  If scatters are displayed (scatter style not \ref QCPScatterStyle::ssNone), \a skip number of
-  scatter points are skipped/not drawn after every drawn scatter point.
+/*! \internal
+*/
+void QCPGraphLodPyramid::rebuild(const QCPGraphDataContainer &data)
+{
+  clear();
+  mLevels.append(std::deque<Bucket>());
+  mFirstBucket.append(0);
+  mFirstKey = data.constBegin()->key;
+  append(data.constBegin(), data.constEnd());
+}
+
+/*! \internal
+
+  Forgets the points before \a absoluteIndex and the buckets that only held such points.
+*/
+void QCPGraphLodPyramid::dropBefore(qint64 absoluteIndex)
+{
+  mAbsoluteBegin = absoluteIndex;
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    std::deque<Bucket> &buckets = mLevels[level];
+    const qint64 size = bucketSize(level);
+    while (buckets.size() > 1 && (mFirstBucket.at(level)+1)*size <= absoluteIndex)
+    {
+      buckets.pop_front();
+      ++mFirstBucket[level];
+    }
+  }
+}
+
+/*! \internal
+
+  Summarizes the points from \a begin to \a end, which follow the points known so far.
+*/
+void QCPGraphLodPyramid::append(QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end)
+{
+  if (begin == end)
+    return;
+  
+  std::deque<Bucket> &level0 = mLevels[0];
+  const qint64 firstChanged = mAbsoluteEnd/BaseBucketSize;
+  for (QCPGraphDataContainer::const_iterator it=begin; it!=end; ++it, ++mAbsoluteEnd)
+  {
+    if (level0.empty() || mAbsoluteEnd%BaseBucketSize == 0)
+      level0.push_back(pointBucket(*it));
+    else
+      mergeBucket(level0.back(), pointBucket(*it));
+  }
+  mLastKey = (end-1)->key;
+  updateParents(firstChanged, (mAbsoluteEnd-1)/BaseBucketSize);
+}
+
+/*! \internal
+
+  Recomputes the buckets of the levels above 0 that contain the level 0 buckets \a firstChild to
+  \a lastChild, and adds a level when the top level has grown to more than one bucket.
+*/
+void QCPGraphLodPyramid::updateParents(qint64 firstChild, qint64 lastChild)
+{
+  for (int level=1; level<MaxLevels; ++level)
+  {
+    if (level == mLevels.size())
+    {
+      if (mLevels.at(level-1).size() < 2)
+        return;
+      // new level, summarize the whole level below:
+      mLevels.append(std::deque<Bucket>());
+      mFirstBucket.append(mFirstBucket.at(level-1)/4);
+      firstChild = mFirstBucket.at(level-1);
+      lastChild = firstChild+qint64(mLevels.at(level-1).size())-1;
+    }
+    
+    const std::deque<Bucket> &children = mLevels.at(level-1);
+    const qint64 childBegin = mFirstBucket.at(level-1);
+    const qint64 childEnd = childBegin+qint64(children.size());
+    std::deque<Bucket> &parents = mLevels[level];
+    const qint64 firstParent = firstChild/4;
+    const qint64 lastParent = lastChild/4;
+    
+    // the changed parents are at the back, recompute them from their children:
+    while (!parents.empty() && mFirstBucket.at(level)+qint64(parents.size()) > firstParent)
+      parents.pop_back();
+    if (parents.empty())
+      mFirstBucket[level] = firstParent;
+    for (qint64 parent=firstParent; parent<=lastParent; ++parent)
+    {
+      const qint64 from = qMax(parent*4, childBegin);
+      const qint64 to = qMin(parent*4+4, childEnd);
+      Bucket bucket = children[size_t(from-childBegin)];
+      for (qint64 child=from+1; child<to; ++child)
+        mergeBucket(bucket, children[size_t(child-childBegin)]);
+      parents.push_back(bucket);
+    }
+    
+    firstChild = firstParent;
+    lastChild = lastParent;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPRasterCanvas
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPRasterCanvas
+  \brief Software rasterizer for dense polylines and scatter stamps
+
+  The canvas is an image covering a rectangle of the paint device (usually the clip rect of a
+  plottable) in device pixels. Polylines are rasterized into it with a Bresenham line (optionally
+  with square pens of several pixels) or a Xiaolin Wu line when antialiased, scatters are blended
+  in as pre-rendered stamp images. \ref end draws the touched part of the image with a single
+  QPainter::drawImage call.
+
+  This avoids the path stroking of QPainter for polylines with hundreds of thousands of segments,
+  at the cost of supporting only solid, single color pens. It is used by \ref QCPGraph when \ref
+  QCPGraph::setRasterRendering is enabled.
+
+  The image is kept between frames, so after warm-up a frame only clears the pixels touched by the
+  previous one.
+*/
+
+namespace {
+/*! \internal
+  Multiplies all four 8 bit channels of \a x by \a a/255.
+*/
+inline quint32 rasterByteMul(quint32 x, quint32 a)
+{
+  quint32 t = (x & 0xff00ff)*a;
+  t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+  t &= 0xff00ff;
+  x = ((x >> 8) & 0xff00ff)*a;
+  x = (x + ((x >> 8) & 0xff00ff) + 0x800080);
+  x &= 0xff00ff00;
+  return x | t;
+}
+}
+
+QCPRasterCanvas::QCPRasterCanvas() :
+  mDevicePixelRatio(1),
+  mBits(nullptr),
+  mStride(0),
+  mDirtyLeft(0),
+  mDirtyTop(0),
+  mDirtyRight(-1),
+  mDirtyBottom(-1)
+{
+}
+
+/*!
+  Prepares the canvas for painting into \a rect (in logical coordinates of the paint device) with
+  the given \a devicePixelRatio. \a offset is the translation of the painter that will be passed to
+  \ref end, points passed to the drawing methods are in the painter's coordinates.
+  
+  Returns false if \a rect is empty.
+*/
+bool QCPRasterCanvas::begin(const QRect &rect, double devicePixelRatio, const QPointF &offset)
+{
+  if (rect.isEmpty())
+    return false;
+  const QSize size(qCeil(rect.width()*devicePixelRatio), qCeil(rect.height()*devicePixelRatio));
+  if (mImage.size() != size)
+  {
+    mImage = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    mImage.fill(Qt::transparent);
+    mDirtyRight = mDirtyBottom = -1;
+  } else
+    clearDirty();
+  mRect = rect;
+  mOffset = offset;
+  mDevicePixelRatio = devicePixelRatio;
+  mBits = reinterpret_cast<quint32*>(mImage.bits());
+  mStride = int(mImage.bytesPerLine()/4);
+  return true;
+}
+
+/*!
+  Draws the polyline through \a points with \a color. NaN points break the line, like \ref
+  QCPAbstractPlottable1D::drawPolyline does. \a width is given in device pixels and rounded to a
+  whole number of pixels; antialiased lines are always one pixel wide.
+*/
+void QCPRasterCanvas::drawPolyline(const QVector<QPointF> &points, const QColor &color, double width, bool antialiased)
+{
+  const quint32 premultiplied = qPremultiply(color.rgba());
+  const int thickness = qMax(1, qRound(width));
+  for (int i=1; i<points.size(); ++i)
+  {
+    const QPointF a = toImage(points.at(i-1));
+    const QPointF b = toImage(points.at(i));
+    if (qIsNaN(a.x()) || qIsNaN(a.y()) || qIsNaN(b.x()) || qIsNaN(b.y()))
+      continue;
+    if (antialiased)
+      drawSegmentAntialiased(a.x()-0.5, a.y()-0.5, b.x()-0.5, b.y()-0.5, premultiplied); // pixel centers are at integer coordinates in Wu's algorithm
+    else
+      drawSegment(a.x(), a.y(), b.x(), b.y(), premultiplied, thickness);
+  }
+}
+
+/*!
+  Blends \a stamp, a premultiplied ARGB image in device pixels, centered at each of \a points.
+*/
+void QCPRasterCanvas::drawStamps(const QVector<QPointF> &points, const QImage &stamp)
+{
+  if (stamp.isNull() || stamp.format() != QImage::Format_ARGB32_Premultiplied)
+    return;
+  const int stampWidth = stamp.width();
+  const int stampHeight = stamp.height();
+  const int stampStride = int(stamp.bytesPerLine()/4);
+  const quint32 *stampBits = reinterpret_cast<const quint32*>(stamp.constBits());
+  const int width = mImage.width();
+  const int height = mImage.height();
+  foreach (const QPointF &point, points)
+  {
+    const QPointF p = toImage(point);
+    if (qIsNaN(p.x()) || qIsNaN(p.y()))
+      continue;
+    const int left = qFloor(p.x()-stampWidth*0.5+0.5);
+    const int top = qFloor(p.y()-stampHeight*0.5+0.5);
+    const int x0 = qMax(left, 0), x1 = qMin(left+stampWidth, width);
+    const int y0 = qMax(top, 0), y1 = qMin(top+stampHeight, height);
+    if (x0 >= x1 || y0 >= y1)
+      continue;
+    for (int y=y0; y<y1; ++y)
+    {
+      const quint32 *src = stampBits+(y-top)*stampStride+(x0-left);
+      quint32 *dst = mBits+y*mStride+x0;
+      for (int x=x0; x<x1; ++x, ++src, ++dst)
+      {
+        const quint32 alpha = qAlpha(*src);
+        if (alpha == 255)
+          *dst = *src;
+        else if (alpha != 0)
+          *dst = *src + rasterByteMul(*dst, 255-alpha);
+      }
+    }
+    markDirty(x0, y0, x1-1, y1-1);
+  }
+}
+
+/*!
+  Draws the part of the canvas that was painted on since \ref begin with \a painter, which must
+  have the translation passed to \ref begin.
+*/
+void QCPRasterCanvas::end(QCPPainter *painter)
+{
+  mBits = nullptr;
+  if (mDirtyRight < mDirtyLeft || mDirtyBottom < mDirtyTop)
+    return;
+  const QRect source(mDirtyLeft, mDirtyTop, mDirtyRight-mDirtyLeft+1, mDirtyBottom-mDirtyTop+1);
+  const QRectF target(mRect.x()-mOffset.x()+source.x()/mDevicePixelRatio,
+                      mRect.y()-mOffset.y()+source.y()/mDevicePixelRatio,
+                      source.width()/mDevicePixelRatio,
+                      source.height()/mDevicePixelRatio);
+  painter->drawImage(target, mImage, source);
+}
+
+/*! \internal
+
+  Clears the pixels painted on in the previous frame.
+*/
+void QCPRasterCanvas::clearDirty()
+{
+  if (mDirtyRight >= mDirtyLeft && mDirtyBottom >= mDirtyTop)
+  {
+    const int bytes = (mDirtyRight-mDirtyLeft+1)*4;
+    for (int y=mDirtyTop; y<=mDirtyBottom; ++y)
+      memset(mImage.scanLine(y)+mDirtyLeft*4, 0, size_t(bytes));
+  }
+  mDirtyLeft = mDirtyTop = 0;
+  mDirtyRight = mDirtyBottom = -1;
+}
+
+/*! \internal
+*/
+void QCPRasterCanvas::markDirty(int left, int top, int right, int bottom)
+{
+  left = qMax(left, 0);
+  top = qMax(top, 0);
+  right = qMin(right, mImage.width()-1);
+  bottom = qMin(bottom, mImage.height()-1);
+  if (right < left || bottom < top)
+    return;
+  if (mDirtyRight < mDirtyLeft || mDirtyBottom < mDirtyTop)
+  {
+    mDirtyLeft = left;
+    mDirtyTop = top;
+    mDirtyRight = right;
+    mDirtyBottom = bottom;
+  } else
+  {
+    mDirtyLeft = qMin(mDirtyLeft, left);
+    mDirtyTop = qMin(mDirtyTop, top);
+    mDirtyRight = qMax(mDirtyRight, right);
+    mDirtyBottom = qMax(mDirtyBottom, bottom);
+  }
+}
+
+/*! \internal
+
+  Blends the premultiplied \a color with the given \a coverage (0..255) over pixel (\a x, \a y).
+  Pixels outside the canvas are ignored.
+*/
+void QCPRasterCanvas::blendPixel(int x, int y, quint32 color, int coverage)
+{
+  if (x < 0 || y < 0 || x >= mImage.width() || y >= mImage.height() || coverage <= 0)
+    return;
+  quint32 &dst = mBits[y*mStride+x];
+  const quint32 src = coverage >= 255 ? color : rasterByteMul(color, quint32(coverage));
+  const quint32 alpha = qAlpha(src);
+  dst = alpha == 255 ? src : src + rasterByteMul(dst, 255-alpha);
+}
+
+/*! \internal
+
+  Bresenham line from (\a x0, \a y0) to (\a x1, \a y1) in image pixels, with a square pen of \a
+  thickness pixels.
+*/
+void QCPRasterCanvas::drawSegment(double x0, double y0, double x1, double y1, quint32 color, int thickness)
+{
+  if (!clipSegment(x0, y0, x1, y1, thickness))
+    return;
+  int ix0 = qFloor(x0), iy0 = qFloor(y0);
+  const int ix1 = qFloor(x1), iy1 = qFloor(y1);
+  const int dx = qAbs(ix1-ix0), dy = -qAbs(iy1-iy0);
+  const int sx = ix0 < ix1 ? 1 : -1, sy = iy0 < iy1 ? 1 : -1;
+  const int penOffset = (thickness-1)/2;
+  markDirty(qMin(ix0, ix1)-penOffset, qMin(iy0, iy1)-penOffset, qMax(ix0, ix1)-penOffset+thickness-1, qMax(iy0, iy1)-penOffset+thickness-1);
+  int error = dx+dy;
+  while (true)
+  {
+    if (thickness == 1)
+      blendPixel(ix0, iy0, color, 255);
+    else
+    {
+      for (int py=0; py<thickness; ++py)
+        for (int px=0; px<thickness; ++px)
+          blendPixel(ix0-penOffset+px, iy0-penOffset+py, color, 255);
+    }
+    if (ix0 == ix1 && iy0 == iy1)
+      break;
+    const int error2 = 2*error;
+    if (error2 >= dy)
+    {
+      error += dy;
+      ix0 += sx;
+    }
+    if (error2 <= dx)
+    {
+      error += dx;
+      iy0 += sy;
+    }
+  }
+}
+
+/*! \internal
+
+  Xiaolin Wu line from (\a x0, \a y0) to (\a x1, \a y1), where pixel centers are at integer
+  coordinates.
+*/
+void QCPRasterCanvas::drawSegmentAntialiased(double x0, double y0, double x1, double y1, quint32 color)
+{
+  if (!clipSegment(x0, y0, x1, y1, 2))
+    return;
+  markDirty(qFloor(qMin(x0, x1))-1, qFloor(qMin(y0, y1))-1, qCeil(qMax(x0, x1))+1, qCeil(qMax(y0, y1))+1);
+  const bool steep = qAbs(y1-y0) > qAbs(x1-x0);
+  if (steep)
+  {
+    qSwap(x0, y0);
+    qSwap(x1, y1);
+  }
+  if (x0 > x1)
+  {
+    qSwap(x0, x1);
+    qSwap(y0, y1);
+  }
+  const double dx = x1-x0;
+  const double gradient = dx > 0 ? (y1-y0)/dx : 0;
+  const int xBegin = qRound(x0);
+  const int xEnd = qRound(x1);
+  double y = y0+gradient*(xBegin-x0);
+  for (int x=xBegin; x<=xEnd; ++x, y+=gradient)
+  {
+    const int iy = qFloor(y);
+    const int coverage = int((y-iy)*255+0.5);
+    if (steep)
+    {
+      blendPixel(iy, x, color, 255-coverage);
+      blendPixel(iy+1, x, color, coverage);
+    } else
+    {
+      blendPixel(x, iy, color, 255-coverage);
+      blendPixel(x, iy+1, color, coverage);
+    }
+  }
+}
+
+/*! \internal
+
+  Clips the segment to the canvas extended by \a margin pixels (Liang-Barsky). Returns false if
+  nothing of the segment remains.
+*/
+bool QCPRasterCanvas::clipSegment(double &x0, double &y0, double &x1, double &y1, double margin) const
+{
+  const double xMin = -margin, yMin = -margin;
+  const double xMax = mImage.width()+margin, yMax = mImage.height()+margin;
+  const double dx = x1-x0, dy = y1-y0;
+  const double p[4] = {-dx, dx, -dy, dy};
+  const double q[4] = {x0-xMin, xMax-x0, y0-yMin, yMax-y0};
+  double t0 = 0, t1 = 1;
+  for (int i=0; i<4; ++i)
+  {
+    if (p[i] == 0)
+    {
+      if (q[i] < 0)
+        return false;
+    } else
+    {
+      const double t = q[i]/p[i];
+      if (p[i] < 0)
+      {
+        if (t > t1) return false;
+        if (t > t0) t0 = t;
+      } else
+      {
+        if (t < t0) return false;
+        if (t < t1) t1 = t;
+      }
+    }
+  }
+  x1 = x0+t1*dx;
+  y1 = y0+t1*dy;
+  x0 = x0+t0*dx;
+  y0 = y0+t0*dy;
+  return true;
+}
+
+/*! \internal
+
+  Maps \a point from painter coordinates to image pixels.
+*/
+QPointF QCPRasterCanvas::toImage(const QPointF &point) const
+{
+  return QPointF((point.x()+mOffset.x()-mRect.x())*mDevicePixelRatio, (point.y()+mOffset.y()-mRect.y())*mDevicePixelRatio);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphColumns
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraphColumns
+  \brief Column-wise storage of graph data, with implicit keys while they are evenly spaced
+
+  \ref QCPGraphDataContainer stores the key and the value of every data point next to each other.
+  QCPGraphColumns stores the values in one contiguous array and the keys in another. As long as the
+  keys are evenly spaced, i.e. the key of point \a i is <tt>start + i*step</tt>, no keys are stored
+  at all and the columns need half the memory of a data container. The first point added defines
+  \a start, the \a step is set with \ref setKeyStep (e.g. from a known sample rate), or else
+  defined by the first two points (\ref setUniformKeys sets both). Every further key is compared
+  with the key the grid predicts. Once a key deviates by more than the key tolerance, the keys are
+  written out and stored explicitly from then on, and the memory is the same as that of a data
+  container.
+
+  By default the tolerance only absorbs rounding, so the keys are exact. A step defined by the
+  first two points carries their jitter, set it with \ref setKeyStep if the step is known. Keys
+  that jitter a little around the grid only stay implicit with a larger tolerance (\ref
+  setKeyTolerance), at the price of keys that are moved onto the grid.
+
+  Points are added in ascending key order (\ref add, \ref addValues), an occasional late point is
+  inserted at its place, and points are removed from the front (\ref removeBefore). Lookups by key
+  (\ref findBegin, \ref findEnd) are a computation instead of a binary search while the keys are
+  uniform, and the value scans of \ref valueRange run over the contiguous value array only.
+
+  The values are also summarized in a min/max pyramid: runs of 16 values, runs of four of those,
+  and so on. It is brought up to date lazily by \ref toGraphData, which only costs the values added
+  since, so the reduction of a key range to a few points per pixel costs O(log n) per pixel
+  instead of a visit of every value in the range.
+
+  A \ref QCPGraph can draw from columns directly, see \ref QCPGraph::setColumns. It then fills its
+  data container with just the points needed for the visible key range, at most a few per pixel.
+*/
+
+/*!
+  Creates an empty column store. The key grid is determined by the first two points added.
+*/
+QCPGraphColumns::QCPGraphColumns() :
+  mBegin(0),
+  mUniformKeys(true),
+  mKeyStart(0),
+  mKeyStep(0),
+  mFixedKeyStep(0),
+  mKeyTolerance(1e-6),
+  mRevision(0),
+  mValueRangeFound(false),
+  mValueRangeValid(false)
+{
+}
+
+/*!
+  Sets the keys of the points added from now on to <tt>start + i*step</tt> without storing them, with
+  \a i counting from the first point. This is only possible while the columns are empty, and \a
+  step must be positive. Afterwards the values can be added without keys, see \ref addValues.
+*/
+void QCPGraphColumns::setUniformKeys(double start, double step)
+{
+  if (!isEmpty())
+  {
+    qDebug() << Q_FUNC_INFO << "columns must be empty";
+    return;
+  }
+  if (!(step > 0))
+  {
+    qDebug() << Q_FUNC_INFO << "step must be positive:" << step;
+    return;
+  }
+  clear();
+  mKeyStart = start;
+  mKeyStep = step;
+}
+
+/*!
+  Sets the distance of uniform keys to \a step, instead of taking it from the first two points
+  added, whose keys may carry jitter. The grid starts at the key of the first point added. Unlike
+  \ref setUniformKeys, the step is kept by \ref clear. Pass 0 to have the first two points define
+  the step again.
+
+  If the columns are not empty, the step applies after the next \ref clear.
+*/
+void QCPGraphColumns::setKeyStep(double step)
+{
+  mFixedKeyStep = step > 0 ? step : 0;
+  if (isEmpty())
+    clear();
+}
+
+/*!
+  Sets how far the key of an added point may deviate from the key the uniform grid predicts, as a
+  fraction of the step, while the keys still count as uniform. Such a point is stored with the grid
+  key, i.e. its key is moved by up to \a fraction of a step. The default is a millionth, which only
+  absorbs rounding, so the keys are exact.
+
+  A larger tolerance keeps the keys of a sampled signal implicit even though its timestamps jitter
+  slightly. The stored keys are then the grid keys and not the added ones, so timestamps move by up
+  to \a fraction of a step without notice. A step that doesn't match the signal exactly, a clock
+  that drifts against the grid or lost samples still make the keys explicit eventually. \a fraction is limited to less than half a step, so every key stays closer to its
+  own grid point than to its neighbours.
+*/
+void QCPGraphColumns::setKeyTolerance(double fraction)
+{
+  mKeyTolerance = qBound(0.0, fraction, 0.49);
+}
+
+/*!
+  Appends a data point. If \a key is smaller than the key of the last point, the point is inserted
+  at its place instead. This needs explicit keys and moves the points after it, so it is meant for
+  the occasional late point, not for unsorted data.
+
+  If the keys have been uniform so far and \a key deviates from the key grid by more than the key
+  tolerance (\ref setKeyTolerance), all keys are stored explicitly from now on.
+*/
+void QCPGraphColumns::add(double key, double value)
+{
+  const int n = size();
+  if (n > 0 && key < keyAt(n-1))
+  {
+    if (mUniformKeys)
+      makeKeysExplicit();
+    const int index = mBegin+upperBound(key);
+    truncateLevels(index);
+    mKeys.insert(index, key);
+    mValues.insert(index, value);
+  } else
+  {
+    if (mUniformKeys)
+    {
+      if (n == 0 && (mKeyStep == 0 || qIsNaN(mKeyStart))) // first point, starts the grid
+      {
+        mValues.clear();
+        mBegin = 0;
+        mKeyStart = key;
+      } else if (mKeyStep > 0)
+      {
+        if (qAbs(key-(mKeyStart+(mBegin+n)*mKeyStep)) > mKeyStep*mKeyTolerance)
+          makeKeysExplicit();
+      } else if (key > mKeyStart) // second point, defines the step
+        mKeyStep = key-mKeyStart;
+      else
+        makeKeysExplicit();
+    }
+    if (!mUniformKeys)
+      mKeys.append(key);
+    mValues.append(value);
+  }
+  
+  if (mValueRangeValid && !qIsNaN(value) && std::isfinite(value))
+  {
+    if (!mValueRangeFound)
+      mValueRange = QCPRange(value, value);
+    else if (value < mValueRange.lower)
+      mValueRange.lower = value;
+    else if (value > mValueRange.upper)
+      mValueRange.upper = value;
+    mValueRangeFound = true;
+  }
+  ++mRevision;
+}
+
+/*! \overload
+
+  Appends the data points in \a data, which should be sorted by key.
+*/
+void QCPGraphColumns::add(const QVector<QCPGraphData> &data)
+{
+  for (int i=0; i<data.size(); ++i)
+    add(data.at(i).key, data.at(i).value);
+}
+
+/*! \overload
+
+  Appends the data points of \a data.
+*/
+void QCPGraphColumns::add(const QCPGraphDataContainer &data)
+{
+  for (QCPGraphDataContainer::const_iterator it=data.constBegin(); it!=data.constEnd(); ++it)
+    add(it->key, it->value);
+}
+
+/*!
+  Appends \a values with the next keys of the uniform key grid, without passing keys. The grid
+  must be known, i.e. set with \ref setUniformKeys, or a step set with \ref setKeyStep or defined by
+  two points and a point added before, and the keys must still be uniform.
+*/
+void QCPGraphColumns::addValues(const QVector<double> &values)
+{
+  if (!mUniformKeys || !(mKeyStep > 0) || qIsNaN(mKeyStart))
+  {
+    qDebug() << Q_FUNC_INFO << "keys are not uniform or their step is unknown";
+    return;
+  }
+  for (int i=0; i<values.size(); ++i)
+    add(mKeyStart+(mBegin+size())*mKeyStep, values.at(i));
+}
+
+/*!
+  Removes all data points with keys smaller than \a key. The memory is kept and reused, the
+  remaining points are moved to the front only once the removed ones outnumber them.
+*/
+void QCPGraphColumns::removeBefore(double key)
+{
+  const int count = lowerBound(key);
+  if (count <= 0)
+    return;
+  
+  // the cached value range stays valid unless a removed value was one of its bounds:
+  if (mValueRangeValid && mValueRangeFound)
+  {
+    for (int i=mBegin; i<mBegin+count; ++i)
+    {
+      if (mValues.at(i) <= mValueRange.lower || mValues.at(i) >= mValueRange.upper)
+      {
+        mValueRangeValid = false;
+        break;
+      }
+    }
+  }
+  mBegin += count;
+  if (mBegin > size())
+  {
+    mKeyStart += mBegin*mKeyStep;
+    mValues.remove(0, mBegin);
+    if (!mUniformKeys)
+      mKeys.remove(0, mBegin);
+    mBegin = 0;
+    mLevels.clear(); // the indices moved, rebuilt on the next use
+  }
+  ++mRevision;
+}
+
+/*!
+  Removes all data points. The key grid is determined anew by the next points added, a step set
+  with \ref setKeyStep is kept.
+*/
+void QCPGraphColumns::clear()
+{
+  mKeys.clear();
+  mValues.clear();
+  mBegin = 0;
+  mUniformKeys = true;
+  // with a fixed step the first point added sets the start:
+  mKeyStart = mFixedKeyStep > 0 ? std::numeric_limits<double>::quiet_NaN() : 0;
+  mKeyStep = mFixedKeyStep;
+  mValueRangeValid = false;
+  mLevels.clear();
+  ++mRevision;
+}
+
+/*!
+  Returns the index of the data point with a key that is equal to, just below, or just above \a
+  key, with the same semantics as \ref QCPDataContainer::findBegin. If the columns are empty, 0 is
+  returned.
+*/
+int QCPGraphColumns::findBegin(double key, bool expandedRange) const
+{
+  int index = lowerBound(key);
+  if (expandedRange && index > 0)
+    --index;
+  return index;
+}
+
+/*!
+  Returns the index after the data point with a key that is equal to, just above, or just below \a
+  key, with the same semantics as \ref QCPDataContainer::findEnd. If the columns are empty, 0 is
+  returned.
+*/
+int QCPGraphColumns::findEnd(double key, bool expandedRange) const
+{
+  int index = upperBound(key);
+  if (expandedRange && index < size())
+    ++index;
+  return index;
+}
+
+/*!
+  Returns the range of the keys of all data points whose value isn't NaN, like \ref
+  QCPDataContainer::keyRange. Since the keys are sorted, this only looks at the points at the ends
+  of the range (and at the sign change for \a signDomain other than \ref QCP::sdBoth).
+*/
+QCPRange QCPGraphColumns::keyRange(bool &foundRange, QCP::SignDomain signDomain) const
+{
+  int begin = 0;
+  int end = size();
+  if (signDomain == QCP::sdNegative)
+    end = lowerBound(0);
+  else if (signDomain == QCP::sdPositive)
+    begin = upperBound(0);
+  
+  const int first = firstNonNan(begin, end);
+  foundRange = first < end;
+  if (!foundRange)
+    return QCPRange();
+  return QCPRange(keyAt(first), keyAt(lastNonNan(first, end)));
+}
+
+/*!
+  Returns the range of the values of the data points in the key range \a inKeyRange, like \ref
+  QCPDataContainer::valueRange. NaN and infinite values are ignored. If \a inKeyRange is equal to
+  <tt>QCPRange()</tt>, all data points are considered.
+
+  The result over all data points in both sign domains is cached and kept up to date by \ref add
+  and \ref removeBefore.
+*/
+QCPRange QCPGraphColumns::valueRange(bool &foundRange, QCP::SignDomain signDomain, const QCPRange &inKeyRange) const
+{
+  const bool restrictKeyRange = inKeyRange != QCPRange();
+  if (!restrictKeyRange && signDomain == QCP::sdBoth && mValueRangeValid)
+  {
+    foundRange = mValueRangeFound;
+    return mValueRange;
+  }
+  
+  int begin = 0;
+  int end = size();
+  if (restrictKeyRange)
+  {
+    begin = findBegin(inKeyRange.lower, false);
+    end = findEnd(inKeyRange.upper, false);
+  }
+  double lower = std::numeric_limits<double>::infinity();
+  double upper = -std::numeric_limits<double>::infinity();
+  if (begin < end)
+    scanValues(mValues.constData()+mBegin+begin, mValues.constData()+mBegin+end, signDomain, lower, upper);
+  foundRange = lower <= upper;
+  const QCPRange range = foundRange ? QCPRange(lower, upper) : QCPRange();
+  
+  if (!restrictKeyRange && signDomain == QCP::sdBoth)
+  {
+    mValueRange = range;
+    mValueRangeFound = foundRange;
+    mValueRangeValid = true;
+  }
+  return range;
+}
+
+/*!
+  Returns the data points with the indices from \a begin up to (excluding) \a end as graph data.
+*/
+QVector<QCPGraphData> QCPGraphColumns::toGraphData(int begin, int end) const
+{
+  begin = qBound(0, begin, size());
+  end = qBound(begin, end, size());
+  QVector<QCPGraphData> result(end-begin);
+  for (int i=begin; i<end; ++i)
+    result[i-begin] = QCPGraphData(keyAt(i), mValues.at(mBegin+i));
+  return result;
+}
+
+/*! \overload
+
+  Returns the data points in \a keyRange as graph data, including the closest points outside of it
+  (like \ref findBegin and \ref findEnd with \a expandedRange). If these are more than four points
+  per bin, \a keyRange is split into \a bins equally wide key intervals, and only the first, the
+  last, the minimum, the maximum and the first NaN point of the points in every interval are
+  returned, in their original order. The points outside of \a keyRange count to the first and the
+  last interval. With as many bins as the key axis is wide in pixels, every bin covers one pixel
+  column, and a line through the returned points looks the same as one through all points, also
+  where the point density changes. If \a bins is 0, all points are returned.
+
+  The extremes of a bin are taken from the min/max pyramid, only the values at the bin edges that
+  don't fill a complete run are visited. So the cost grows with \a bins and only logarithmically
+  with the number of points in \a keyRange.
+*/
+QVector<QCPGraphData> QCPGraphColumns::toGraphData(const QCPRange &keyRange, int bins) const
+{
+  const int begin = findBegin(keyRange.lower);
+  const int end = findEnd(keyRange.upper);
+  const int count = end-begin;
+  if (bins <= 0 || count <= 4*bins)
+    return toGraphData(begin, end);
+  
+  syncLevels();
+  QVector<QCPGraphData> result;
+  result.reserve(5*bins);
+  const double *values = mValues.constData()+mBegin;
+  const double binWidth = keyRange.size()/bins;
+  int binEnd = begin;
+  for (int bin=0; bin<bins; ++bin)
+  {
+    // the bins split at key boundaries, so the points of a bin share one pixel column:
+    const int binBegin = binEnd;
+    binEnd = bin == bins-1 ? end : qBound(binBegin, lowerBound(keyRange.lower+(bin+1)*binWidth), end);
+    if (binBegin == binEnd)
+      continue;
+    const Extremes binExtremes = extremes(mBegin+binBegin, mBegin+binEnd);
+    int indices[5] = {binBegin, binBegin, binBegin, -1, binEnd-1}; // first, minimum, maximum, first NaN, last
+    if (binExtremes.minIndex >= 0)
+    {
+      indices[1] = binExtremes.minIndex-mBegin;
+      indices[2] = binExtremes.maxIndex-mBegin;
+    }
+    if (binExtremes.nanIndex >= 0)
+      indices[3] = binExtremes.nanIndex-mBegin;
+    std::sort(indices, indices+5);
+    int previous = -1;
+    for (int k=0; k<5; ++k)
+    {
+      if (indices[k] > previous)
+      {
+        result.append(QCPGraphData(keyAt(indices[k]), values[indices[k]]));
+        previous = indices[k];
+      }
+    }
+  }
+  return result;
+}
+
+/*! \internal
+
+  Summarizes the complete runs of values that were added since the last call in the min/max
+  pyramid. Every level only grows at its end, so this costs O(1) amortized per added value.
+*/
+void QCPGraphColumns::syncLevels() const
+{
+  const int n = mValues.size();
+  for (int level=0; ; ++level)
+  {
+    const qint64 bucketSize = qint64(BaseBucketSize) << (2*level);
+    if (level == mLevels.size())
+    {
+      if (n < bucketSize)
+        break;
+      mLevels.append(QVector<Extremes>());
+    }
+    QVector<Extremes> &buckets = mLevels[level];
+    while ((buckets.size()+1)*bucketSize <= n)
+    {
+      Extremes bucket = {-1, -1, -1};
+      if (level == 0)
+      {
+        const int begin = buckets.size()*BaseBucketSize;
+        for (int i=begin; i<begin+BaseBucketSize; ++i)
+          addExtremes(bucket, i);
+      } else
+      {
+        const QVector<Extremes> &children = mLevels.at(level-1);
+        for (int i=4*buckets.size(); i<4*buckets.size()+4; ++i)
+          addExtremes(bucket, children.at(i));
+      }
+      buckets.append(bucket);
+    }
+  }
+}
+
+/*! \internal
+
+  Drops the buckets of the min/max pyramid that hold the value at \a index of mValues or later
+  ones, before values are inserted there.
+*/
+void QCPGraphColumns::truncateLevels(int index)
+{
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    const int keep = int(index/(qint64(BaseBucketSize) << (2*level)));
+    if (mLevels.at(level).size() > keep)
+      mLevels[level].resize(keep);
+  }
+}
+
+/*! \internal
+
+  Returns the indices of the minimum, the maximum and the first NaN of the values from \a begin up
+  to (excluding) \a end of mValues. Equal extremes resolve to the first one. The pyramid must have
+  been synchronized before (\ref syncLevels). At every position the largest bucket that starts
+  there and ends before \a end is used, so only O(log n) buckets and single values are visited.
+*/
+QCPGraphColumns::Extremes QCPGraphColumns::extremes(int begin, int end) const
+{
+  Extremes result = {-1, -1, -1};
+  int index = begin;
+  while (index < end)
+  {
+    int level = -1;
+    qint64 bucketSize = 1;
+    while (level+1 < mLevels.size())
+    {
+      const qint64 nextSize = qint64(BaseBucketSize) << (2*(level+1));
+      if (index%nextSize != 0 || index+nextSize > end || index/nextSize >= mLevels.at(level+1).size())
+        break;
+      ++level;
+      bucketSize = nextSize;
+    }
+    if (level < 0)
+      addExtremes(result, index);
+    else
+      addExtremes(result, mLevels.at(level).at(int(index/bucketSize)));
+    index += int(bucketSize);
+  }
+  return result;
+}
+
+/*! \internal
+
+  Extends \a target by the value at \a index of mValues, which follows the values of \a target.
+*/
+void QCPGraphColumns::addExtremes(Extremes &target, int index) const
+{
+  const double value = mValues.at(index);
+  if (qIsNaN(value))
+  {
+    if (target.nanIndex < 0)
+      target.nanIndex = index;
+    return;
+  }
+  if (target.minIndex < 0 || value < mValues.at(target.minIndex))
+    target.minIndex = index;
+  if (target.maxIndex < 0 || value > mValues.at(target.maxIndex))
+    target.maxIndex = index;
+}
+
+/*! \internal \overload
+
+  Extends \a target by the bucket \a source, which follows the values of \a target.
+*/
+void QCPGraphColumns::addExtremes(Extremes &target, const Extremes &source) const
+{
+  if (source.minIndex >= 0 && (target.minIndex < 0 || mValues.at(source.minIndex) < mValues.at(target.minIndex)))
+    target.minIndex = source.minIndex;
+  if (source.maxIndex >= 0 && (target.maxIndex < 0 || mValues.at(source.maxIndex) > mValues.at(target.maxIndex)))
+    target.maxIndex = source.maxIndex;
+  if (target.nanIndex < 0)
+    target.nanIndex = source.nanIndex;
+}
+
+/*! \internal
+
+  Writes out the keys of the uniform grid, from now on every key is stored.
+*/
+void QCPGraphColumns::makeKeysExplicit()
+{
+  mKeys.resize(mValues.size());
+  for (int i=0; i<mValues.size(); ++i)
+    mKeys[i] = mKeyStart+i*mKeyStep;
+  mUniformKeys = false;
+}
+
+/*! \internal
+
+  Returns the index of the first data point with a key not smaller than \a key, or \ref size if
+  there is none. With uniform keys, the index is computed and only corrected for rounding.
+*/
+int QCPGraphColumns::lowerBound(double key) const
+{
+  const int n = size();
+  if (!mUniformKeys)
+    return int(std::lower_bound(mKeys.constBegin()+mBegin, mKeys.constEnd(), key)-(mKeys.constBegin()+mBegin));
+  
+  int index = 0;
+  if (mKeyStep > 0 && n > 0)
+  {
+    const double position = std::ceil((key-keyAt(0))/mKeyStep);
+    index = position > 0 ? (position < n ? int(position) : n) : 0;
+  }
+  while (index > 0 && keyAt(index-1) >= key)
+    --index;
+  while (index < n && keyAt(index) < key)
+    ++index;
+  return index;
+}
+
+/*! \internal
+
+  Returns the index of the first data point with a key greater than \a key, or \ref size if there
+  is none. With uniform keys, the index is computed and only corrected for rounding.
+*/
+int QCPGraphColumns::upperBound(double key) const
+{
+  const int n = size();
+  if (!mUniformKeys)
+    return int(std::upper_bound(mKeys.constBegin()+mBegin, mKeys.constEnd(), key)-(mKeys.constBegin()+mBegin));
+  
+  int index = 0;
+  if (mKeyStep > 0 && n > 0)
+  {
+    const double position = std::floor((key-keyAt(0))/mKeyStep)+1;
+    index = position > 0 ? (position < n ? int(position) : n) : 0;
+  }
+  while (index > 0 && keyAt(index-1) > key)
+    --index;
+  while (index < n && keyAt(index) <= key)
+    ++index;
+  return index;
+}
+
+/*! \internal
+
+  Returns the index of the first point from \a begin on whose value isn't NaN, or \a end.
+*/
+int QCPGraphColumns::firstNonNan(int begin, int end) const
+{
+  while (begin < end && qIsNaN(mValues.at(mBegin+begin)))
+    ++begin;
+  return begin;
+}
+
+/*! \internal
+
+  Returns the index of the last point before \a end whose value isn't NaN. There must be one at or
+  after \a begin.
+*/
+int QCPGraphColumns::lastNonNan(int begin, int end) const
+{
+  int index = end-1;
+  while (index > begin && qIsNaN(mValues.at(mBegin+index)))
+    --index;
+  return index;
+}
+
+/*! \internal
+
+  Expands \a lower and \a upper to the values from \a begin to \a end that are in \a signDomain.
+  NaN and infinite values fail both comparisons with the domain limits, so the loop has no other
+  branches than the ones selecting the extremes.
+*/
+void QCPGraphColumns::scanValues(const double *begin, const double *end, QCP::SignDomain signDomain, double &lower, double &upper)
+{
+  double minimum = -(std::numeric_limits<double>::max)();
+  double maximum = (std::numeric_limits<double>::max)();
+  if (signDomain == QCP::sdNegative)
+    maximum = -std::numeric_limits<double>::denorm_min();
+  else if (signDomain == QCP::sdPositive)
+    minimum = std::numeric_limits<double>::denorm_min();
+  
+  for (const double *it=begin; it!=end; ++it)
+  {
+    const double value = *it;
+    if (value >= minimum && value <= maximum)
+    {
+      lower = value < lower ? value : lower;
+      upper = value > upper ? value : upper;
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraph
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraph
+  \brief A plottable representing a graph in a plot.
+
+  \image html QCPGraph.png
+  
+  Usually you create new graphs by calling QCustomPlot::addGraph. The resulting instance can be
+  accessed via QCustomPlot::graph.
+
+  To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
+  also access and modify the data via the \ref data method, which returns a pointer to the internal
+  \ref QCPGraphDataContainer.
+  
+  Graphs are used to display single-valued data. Single-valued means that there should only be one
+  data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
+  want to plot non-single-valued curves, rather use the QCPCurve plottable.
+  
+  Gaps in the graph line can be created by adding data points with NaN as value
+  (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
+  separated.
+  
+  \section qcpgraph-appearance Changing the appearance
+  
+  The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
+  of the graph (\ref setLineStyle, \ref setScatterStyle, \ref setBrush, \ref setPen).
+  
+  \subsection filling Filling under or between graphs
+  
+  QCPGraph knows two types of fills: Normal graph fills towards the zero-value-line parallel to
+  the key axis of the graph, and fills between two graphs, called channel fills. To enable a fill,
+  just set a brush with \ref setBrush which is neither Qt::NoBrush nor fully transparent.
+  
+  By default, a normal fill towards the zero-value-line will be drawn. To set up a channel fill
+  between this graph and another one, call \ref setChannelFillGraph with the other graph as
+  parameter.
+
+  \see QCustomPlot::addGraph, QCustomPlot::graph
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QSharedPointer<QCPGraphDataContainer> QCPGraph::data() const
+  
+  Returns a shared pointer to the internal data storage of type \ref QCPGraphDataContainer. You may
+  use it to directly manipulate the data, which may be more convenient and faster than using the
+  regular \ref setData or \ref addData methods.
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Constructs a graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value
+  axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not have
+  the same orientation. If either of these restrictions is violated, a corresponding message is
+  printed to the debug output (qDebug), the construction is not aborted, though.
+  
+  The created QCPGraph is automatically registered with the QCustomPlot instance inferred from \a
+  keyAxis. This QCustomPlot instance takes ownership of the QCPGraph, so do not delete it manually
+  but use QCustomPlot::removePlottable() instead.
+  
+  To directly create a graph inside a plot, you can also use the simpler QCustomPlot::addGraph function.
+*/
+QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable1D<QCPGraphData>(keyAxis, valueAxis),
+  mLineStyle{},
+  mScatterSkip{},
+  mAdaptiveSampling{},
+  mLevelOfDetail{},
+  mRasterRendering{},
+  mColumnsBins(0),
+  mColumnsRevision(0),
+  mColumnsViewValid(false)
+{
+  // special handling for QCPGraphs to maintain the simple graph interface:
+  mParentPlot->registerGraph(this);
+
+  setPen(QPen(Qt::blue, 0));
+  setBrush(Qt::NoBrush);
+  
+  setLineStyle(lsLine);
+  setScatterSkip(0);
+  setChannelFillGraph(nullptr);
+  setAdaptiveSampling(true);
+  setLevelOfDetail(true);
+  setRasterRendering(false);
+}
+
+QCPGraph::~QCPGraph()
+{
+}
+
+/*! \overload
+  
+  Replaces the current data container with the provided \a data container.
+  
+  Since a QSharedPointer is used, multiple QCPGraphs may share the same data container safely.
+  Modifying the data in the container will then affect all graphs that share the container. Sharing
+  can be achieved by simply exchanging the data containers wrapped in shared pointers:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-1
+  
+  If you do not wish to share containers, but create a copy from an existing container, rather use
+  the \ref QCPDataContainer<DataType>::set method on the graph's data container directly:
+  \snippet documentation/doc-code-snippets/mainwindow.cpp qcpgraph-datasharing-2
+  
+  \see addData
+*/
+void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
+{
+  mDataContainer = data;
+  mLodPyramid.clear();
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided points in \a keys and \a values. The provided
+  vectors should have equal length. Else, the number of added points will be the size of the
+  smallest vector.
+  
+  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
+  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+  
+  \see addData
+*/
+void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  mDataContainer->clear();
+  addData(keys, values, alreadySorted);
+}
+
+/*!
+  Sets how the single data points are connected in the plot. For scatter-only plots, set \a ls to
+  \ref lsNone and \ref setScatterStyle to the desired scatter style.
+  
+  \see setScatterStyle
+*/
+void QCPGraph::setLineStyle(LineStyle ls)
+{
+  mLineStyle = ls;
+}
+
+/*!
+  Sets the visual appearance of single data points in the plot. If set to \ref QCPScatterStyle::ssNone, no scatter points
+  are drawn (e.g. for line-only-plots with appropriate line style).
+  
+  \see QCPScatterStyle, setLineStyle
+*/
+void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
+{
+  mScatterStyle = style;
+}
+
+/*!
+  If scatters are displayed (scatter style not \ref QCPScatterStyle::ssNone), \a skip number of
+  scatter points are skipped/not drawn after every drawn scatter point.
 
   This can be used to make the data appear sparser while for example still having a smooth line,
   and to improve performance for very high density plots.
@@ -21038,6 +22534,78 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
   mAdaptiveSampling = enabled;
 }
 
+/*!
+  Sets whether the graph keeps a min/max pyramid of its data (see \ref QCPGraphLodPyramid) to speed
+  up adaptive sampling of line plots.
+  
+  When enabled and many data points fall on one pixel, the line is built from the pyramid level
+  that matches the pixel width instead of from every visible data point, so zoomed-out views of
+  millions of points take time proportional to the pixel width of the graph. The pyramid is
+  updated incrementally while data is appended and removed at the front, e.g. in a scrolling
+  stream. It costs roughly a third of the memory of the data itself.
+  
+  The result is the same as with plain adaptive sampling, except that the position of a cluster
+  may be off by the width of one pyramid bucket, which is less than half a pixel. Gaps (NaN values)
+  within a pixel are kept as a break after the cluster.
+  
+  Has no effect if adaptive sampling is disabled (\ref setAdaptiveSampling). By default, the level
+  of detail pyramid is enabled.
+*/
+void QCPGraph::setLevelOfDetail(bool enabled)
+{
+  mLevelOfDetail = enabled;
+  if (!enabled)
+    mLodPyramid.clear();
+}
+
+/*!
+  Sets whether lines and scatters of this graph are rasterized in software (see \ref
+  QCPRasterCanvas) instead of being drawn with QPainter.
+  
+  This is meant for dense graphs on systems without GPU, where stroking a polyline of hundreds of
+  thousands of points and drawing a vector symbol per data point dominate the replot time. Lines
+  are drawn with a Bresenham or, when antialiased, a Xiaolin Wu algorithm, and scatters are blended
+  directly into the canvas from the cached symbol image of \ref QCPScatterStyle::stamp.
+  
+  Only solid, single color pens are rasterized, the graph falls back to QPainter for other pens,
+  for scatter styles \ref QCPScatterStyle::ssPixmap and \ref QCPScatterStyle::ssCustom, for
+  vectorized output (e.g. PDF export) and for painters with a scaling or rotating transform. Fills
+  and impulse plots are always drawn with QPainter.
+  
+  Antialiased lines wider than one pixel are not supported by the rasterizer and are drawn with
+  QPainter as well.
+*/
+void QCPGraph::setRasterRendering(bool enabled)
+{
+  mRasterRendering = enabled;
+  if (!enabled)
+    mRasterCanvas = QCPRasterCanvas();
+}
+
+/*!
+  Makes the graph draw the data points stored in \a columns, instead of the points in its data
+  container. Pass a null pointer to go back to the data container.
+
+  This is meant for long recordings: \ref QCPGraphColumns needs half the memory of \ref
+  QCPGraphDataContainer while the keys stay on an even grid (see \ref
+  QCPGraphColumns::setKeyStep). Before every draw, the graph fills its
+  data container with the points of the visible key range, and if adaptive sampling is enabled
+  (\ref setAdaptiveSampling) and the key axis is linear, with at most a few points per pixel (see
+  \ref QCPGraphColumns::toGraphData). So the data container stays small and is only refilled when
+  the columns or the key range changed. A refill takes the extremes from the min/max pyramid of
+  the columns, so it costs O(log n) per pixel and not a visit of every visible point. The level of
+  detail pyramid of the graph (\ref setLevelOfDetail) isn't needed for these few points. The automatic axis rescaling (\ref getKeyRange, \ref
+  getValueRange) uses all points in the columns.
+
+  While columns are set, \ref data only holds the points of the last draw and shouldn't be
+  modified, and data selections refer to these points.
+*/
+void QCPGraph::setColumns(QSharedPointer<QCPGraphColumns> columns)
+{
+  mColumns = columns;
+  mColumnsViewValid = false;
+}
+
 /*! \overload
   
   Adds the provided points in \a keys and \a values to the current data. The provided vectors
@@ -21113,12 +22681,16 @@ double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
 /* inherits documentation from base class */
 QCPRange QCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
 {
+  if (mColumns)
+    return mColumns->keyRange(foundRange, inSignDomain);
   return mDataContainer->keyRange(foundRange, inSignDomain);
 }
 
 /* inherits documentation from base class */
 QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
 {
+  if (mColumns)
+    return mColumns->valueRange(foundRange, inSignDomain, inKeyRange);
   return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
 }
 
@@ -21126,6 +22698,8 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain,
 void QCPGraph::draw(QCPPainter *painter)
 {
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (mColumns)
+    updateColumnsView();
   if (mKeyAxis.data()->range().size() <= 0 || mDataContainer->isEmpty()) return;
   if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
   
@@ -21639,6 +23213,8 @@ void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lines) const
 void QCPGraph::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &scatters, const QCPScatterStyle &style) const
 {
   applyScattersAntialiasingHint(painter);
+  if (drawRasterScatters(painter, scatters, style))
+    return;
   style.applyTo(painter, mPen);
   foreach (const QPointF &scatter, scatters)
     style.drawShape(painter, scatter.x(), scatter.y());
@@ -21655,7 +23231,8 @@ void QCPGraph::drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines)
   if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
   {
     applyDefaultAntialiasingHint(painter);
-    drawPolyline(painter, lines);
+    if (!drawRasterPolyline(painter, lines))
+      drawPolyline(painter, lines);
   }
 }
 
@@ -21703,15 +23280,29 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
   
   int dataCount = int(end-begin);
   int maxCount = (std::numeric_limits<int>::max)();
+  double keyPixelSpan = 0;
   if (mAdaptiveSampling)
   {
-    double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
+    keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
     if (2*keyPixelSpan+2 < static_cast<double>((std::numeric_limits<int>::max)()))
       maxCount = int(2*keyPixelSpan+2);
   }
   
   if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
   {
+    // with many points per pixel, walk the buckets of the level of detail pyramid instead of the points:
+    const double pointsPerPixel = dataCount/qMax(keyPixelSpan, 1.0);
+    if (mLevelOfDetail && pointsPerPixel >= 2.0*QCPGraphLodPyramid::BaseBucketSize)
+    {
+      mLodPyramid.sync(*mDataContainer);
+      const int level = mLodPyramid.levelForPointsPerPixel(pointsPerPixel);
+      if (level >= 0)
+      {
+        getLodLineData(lineData, begin, end, level);
+        return;
+      }
+    }
+    
     QCPGraphDataContainer::const_iterator it = begin;
     double minValue = it->value;
     double maxValue = it->value;
@@ -21773,6 +23364,166 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
   }
 }
 
+/*! \internal
+
+  Prepares \ref mRasterCanvas for the clip rect of the graph, if raster rendering is enabled (\ref
+  setRasterRendering) and possible with \a painter. Returns whether the canvas may be used.
+*/
+bool QCPGraph::beginRaster(QCPPainter *painter) const
+{
+  if (!mRasterRendering || painter->modes().testFlag(QCPPainter::pmVectorized))
+    return false;
+  const QTransform transform = painter->transform();
+  if (transform.type() > QTransform::TxTranslate || !painter->device())
+    return false;
+  return mRasterCanvas.begin(clipRect(), painter->device()->devicePixelRatioF(), QPointF(transform.dx(), transform.dy()));
+}
+
+/*! \internal
+
+  Rasterizes the polyline \a lines with the pen of \a painter, see \ref setRasterRendering. Returns
+  false if the pen can't be rasterized, in which case nothing was drawn.
+*/
+bool QCPGraph::drawRasterPolyline(QCPPainter *painter, const QVector<QPointF> &lines) const
+{
+  const QPen pen = painter->pen();
+  if (pen.style() != Qt::SolidLine || pen.brush().style() != Qt::SolidPattern)
+    return false;
+  if (!painter->device())
+    return false;
+  const double width = qMax(1.0, pen.widthF())*painter->device()->devicePixelRatioF();
+  const bool antialiased = painter->testRenderHint(QPainter::Antialiasing);
+  if (antialiased && width > 1.5)
+    return false;
+  if (!beginRaster(painter))
+    return false;
+  mRasterCanvas.drawPolyline(lines, pen.color(), width, antialiased);
+  mRasterCanvas.end(painter);
+  return true;
+}
+
+/*! \internal
+
+  Blends the image of \a style (see \ref QCPScatterStyle::stamp) at every point in \a scatters, see
+  \ref setRasterRendering. Returns false if \a style can't be rasterized, in which case nothing was
+  drawn.
+*/
+bool QCPGraph::drawRasterScatters(QCPPainter *painter, const QVector<QPointF> &scatters, const QCPScatterStyle &style) const
+{
+  if (!mRasterRendering || !painter->device())
+    return false;
+  const QImage stamp = style.stamp(style.isPenDefined() ? style.pen() : mPen, style.brush(), painter->device()->devicePixelRatioF(), painter->antialiasing());
+  if (stamp.isNull() || !beginRaster(painter))
+    return false;
+  mRasterCanvas.drawStamps(scatters, stamp);
+  mRasterCanvas.end(painter);
+  return true;
+}
+
+/*! \internal
+
+  Fills the data container with the points of \ref setColumns that are needed to draw the visible
+  key range, unless the columns and the key range haven't changed since the last time. With
+  adaptive sampling on a linear key axis, the points are reduced to one bin per pixel.
+*/
+void QCPGraph::updateColumnsView()
+{
+  const QCPRange keyRange = mKeyAxis->range();
+  int bins = 0;
+  if (mAdaptiveSampling && mKeyAxis->scaleType() == QCPAxis::stLinear)
+    bins = qMax(1, qRound(qAbs(mKeyAxis->coordToPixel(keyRange.upper)-mKeyAxis->coordToPixel(keyRange.lower))));
+  if (mColumnsViewValid && mColumns->revision() == mColumnsRevision && keyRange == mColumnsKeyRange && bins == mColumnsBins)
+    return;
+  
+  mDataContainer->set(mColumns->toGraphData(keyRange, bins), true);
+  mColumnsKeyRange = keyRange;
+  mColumnsBins = bins;
+  mColumnsRevision = mColumns->revision();
+  mColumnsViewValid = true;
+}
+
+/*! \internal
+
+  Same as the adaptive sampling of \ref getOptimizedLineData, but the points between \a begin and
+  \a end are taken from the buckets of \a level of the level of detail pyramid where possible. Only
+  the points before the first and after the last complete bucket are visited one by one.
+  
+  The pyramid must have been synchronized with the data container before.
+*/
+void QCPGraph::getLodLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end, int level) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  const qint64 bucketSize = mLodPyramid.bucketSize(level);
+  const qint64 beginIndex = mLodPyramid.absoluteIndex(int(begin-mDataContainer->constBegin()));
+  const qint64 endIndex = mLodPyramid.absoluteIndex(int(end-mDataContainer->constBegin()));
+  const qint64 firstBucket = (beginIndex+bucketSize-1)/bucketSize;
+  const qint64 lastBucket = endIndex/bucketSize; // exclusive, only complete buckets are used
+  
+  const int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+  const int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of intervalStartKey
+  const bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic;
+  
+  QCPGraphLodPyramid::Bucket cluster{}; // all points of the current pixel interval
+  bool haveCluster = false;
+  double intervalStartKey = 0;
+  double keyEpsilon = 0;
+  double lastIntervalEndKey = std::numeric_limits<double>::lowest();
+  
+  // emits the current pixel interval like the point based adaptive sampling does:
+  auto flush = [&](double nextKey)
+  {
+    if (cluster.count >= 2)
+    {
+      if (cluster.minValue <= cluster.maxValue) // the cluster has values that are not NaN
+      {
+        if (lastIntervalEndKey < intervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+          lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.2, cluster.firstValue));
+        lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.25, cluster.minValue));
+        lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.75, cluster.maxValue));
+        if (nextKey > intervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
+          lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.8, cluster.lastValue));
+      }
+      if (cluster.hasNan) // keep the gap as a line break
+        lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.9, qQNaN()));
+    } else
+      lineData->append(QCPGraphData(cluster.firstKey, cluster.firstValue));
+    lastIntervalEndKey = cluster.lastKey;
+  };
+  auto addItem = [&](const QCPGraphLodPyramid::Bucket &item)
+  {
+    if (haveCluster && item.firstKey < intervalStartKey+keyEpsilon) // still within the same pixel
+    {
+      QCPGraphLodPyramid::mergeBucket(cluster, item);
+      return;
+    }
+    if (haveCluster)
+      flush(item.firstKey);
+    intervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(item.firstKey)+reversedRound));
+    if (!haveCluster || keyEpsilonVariable)
+      keyEpsilon = qAbs(intervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(intervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    cluster = item;
+    haveCluster = true;
+  };
+  
+  if (firstBucket < lastBucket)
+  {
+    const QCPGraphDataContainer::const_iterator bucketsBegin = begin+int(firstBucket*bucketSize-beginIndex);
+    const QCPGraphDataContainer::const_iterator bucketsEnd = begin+int(lastBucket*bucketSize-beginIndex);
+    for (QCPGraphDataContainer::const_iterator it=begin; it!=bucketsBegin; ++it)
+      addItem(QCPGraphLodPyramid::pointBucket(*it));
+    for (qint64 bucket=firstBucket; bucket<lastBucket; ++bucket)
+      addItem(mLodPyramid.bucket(level, bucket));
+    for (QCPGraphDataContainer::const_iterator it=bucketsEnd; it!=end; ++it)
+      addItem(QCPGraphLodPyramid::pointBucket(*it));
+  } else
+  {
+    for (QCPGraphDataContainer::const_iterator it=begin; it!=end; ++it)
+      addItem(QCPGraphLodPyramid::pointBucket(*it));
+  }
+  if (haveCluster)
+    flush(std::numeric_limits<double>::lowest()); // last interval has no successor
+}
+
 /*! \internal
 
   Returns via \a scatterData the data points that need to be visualized for this graph when
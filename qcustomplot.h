@@ -69,6 +69,7 @@
 #include <qmath.h>
 #include <limits>
 #include <algorithm>
+#include <deque>
 #ifdef QCP_OPENGL_FBO
 #  include <QtGui/QOpenGLContext>
 #  if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
@@ -2577,6 +2578,7 @@ public:
   void applyTo(QCPPainter *painter, const QPen &defaultPen) const;
   void drawShape(QCPPainter *painter, const QPointF &pos) const;
   void drawShape(QCPPainter *painter, double x, double y) const;
+  QImage stamp(const QPen &pen, const QBrush &brush, double devicePixelRatio, bool antialiased) const;
 
 protected:
   // property members:
@@ -2589,6 +2591,15 @@ protected:
   
   // non-property members:
   bool mPenDefined;
+  mutable QImage mStamp;
+  mutable QPen mStampPen;
+  mutable QBrush mStampBrush;
+  mutable double mStampRatio;
+  mutable bool mStampAntialiased;
+  
+  // non-virtual methods:
+  bool canUseStamp(QCPPainter *painter) const;
+  void drawVectorShape(QCPPainter *painter, double x, double y) const;
 };
 Q_DECLARE_TYPEINFO(QCPScatterStyle, Q_MOVABLE_TYPE);
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCPScatterStyle::ScatterProperties)
@@ -2622,9 +2633,11 @@ public:
   int size() const { return mData.size()-mPreallocSize; }
   bool isEmpty() const { return size() == 0; }
   bool autoSqueeze() const { return mAutoSqueeze; }
+  int capacity() const { return mCapacity; }
   
   // setters:
   void setAutoSqueeze(bool enabled);
+  void setCapacity(int capacity);
   
   // non-virtual methods:
   void set(const QCPDataContainer<DataType> &data);
@@ -2642,8 +2655,8 @@ public:
   
   const_iterator constBegin() const { return mData.constBegin()+mPreallocSize; }
   const_iterator constEnd() const { return mData.constEnd(); }
-  iterator begin() { return mData.begin()+mPreallocSize; }
-  iterator end() { return mData.end(); }
+  iterator begin() { invalidateRangeCache(); return mData.begin()+mPreallocSize; }
+  iterator end() { invalidateRangeCache(); return mData.end(); }
   const_iterator findBegin(double sortKey, bool expandedRange=true) const;
   const_iterator findEnd(double sortKey, bool expandedRange=true) const;
   const_iterator at(int index) const { return constBegin()+qBound(0, index, size()); }
@@ -2655,15 +2668,34 @@ public:
 protected:
   // property members:
   bool mAutoSqueeze;
+  int mCapacity;
   
   // non-property memebers:
   QVector<DataType> mData;
   int mPreallocSize;
   int mPreallocIteration;
   
+  // cached results of keyRange and valueRange over all data points, indexed by QCP::SignDomain:
+  struct RangeCache
+  {
+    QCPRange range;
+    bool haveLower, haveUpper, valid;
+  };
+  RangeCache mKeyRangeCache[3];
+  RangeCache mValueRangeCache[3];
+  
   // non-virtual methods:
+  iterator internalBegin() { return mData.begin()+mPreallocSize; }
+  iterator internalEnd() { return mData.end(); }
   void preallocateGrow(int minimumPreallocSize);
   void performAutoSqueeze();
+  void makeRoom(int n);
+  void enforceCapacity();
+  void invalidateRangeCache();
+  void expandRangeCache(const DataType &data);
+  void expandRangeCache(const_iterator begin, const_iterator end);
+  void shrinkRangeCache(const_iterator begin, const_iterator end);
+  static void expandCachedRange(RangeCache &cache, double lower, double upper, QCP::SignDomain signDomain, bool finiteOnly);
 };
 
 
@@ -2694,6 +2726,15 @@ protected:
   \ref end). Changing data members that are not the sort key (for most data types called \a key) is
   safe from the container's perspective.
 
+  The container remembers the results of \ref keyRange and \ref valueRange over all data points.
+  Adding data only expands the remembered ranges by the new points, and removing data only
+  inspects the removed points, discarding a remembered range if one of them lies on its bounds.
+  This way, repeated automatic axis rescaling of a continuously appended and trimmed data set
+  (e.g. a scrolling real-time plot) doesn't need to go through all data points every time.
+  Obtaining the non-const iterators discards the remembered ranges, since the data may be changed
+  through them. So if you modify data points through iterators, don't keep them across calls to
+  \ref keyRange or \ref valueRange, but obtain them anew.
+
   Great care must be taken however if the sort key is modified through the non-const iterators. For
   performance reasons, the iterators don't automatically cause a re-sorting upon their
   manipulation. It is thus the responsibility of the user to leave the container in a sorted state
@@ -2702,6 +2743,16 @@ protected:
   sort. Failing to do so can not be detected by the container efficiently and will cause both
   rendering artifacts and potential data loss.
 
+  For plots that only show the most recent data, e.g. a fixed history depth of a real-time stream,
+  the container can be given a fixed capacity with \ref setCapacity. It then acts as a ring buffer:
+  Adding data beyond the capacity drops the data points with the smallest sort keys, and the buffer
+  is allocated once with twice the capacity. Dropped points at the front just become free space,
+  and when the free space behind the last data point runs out, the kept points are moved to the
+  start of the buffer in one go. Unlike a wrapped ring buffer, the data points thus always stay
+  contiguous, so the iterators, \ref findBegin and \ref findEnd work unchanged, while continuously
+  appending costs amortized O(1) per point and doesn't allocate memory after the buffer was filled
+  once.
+
   Implementing one-dimensional plottables that make use of a \ref QCPDataContainer<T> is usually
   done by subclassing from \ref QCPAbstractPlottable1D "QCPAbstractPlottable1D<T>", which
   introduces an according \a mDataContainer member and some convenience methods.
@@ -2742,6 +2793,14 @@ protected:
 
 /* start documentation of inline functions */
 
+/*! \fn int QCPDataContainer<DataType>::capacity() const
+  
+  Returns the maximum number of data points kept in this container, or 0 if the number is not
+  limited.
+
+  \see setCapacity
+*/
+
 /*! \fn int QCPDataContainer<DataType>::size() const
   
   Returns the number of data points in the container.
@@ -2769,6 +2828,9 @@ protected:
   You can manipulate the data points in-place through the non-const iterators, but great care must
   be taken when manipulating the sort key of a data point, see \ref sort, or the detailed
   description of this class.
+
+  Calling this method discards the cached key and value ranges (see \ref keyRange, \ref
+  valueRange), so prefer \ref constBegin for read-only access.
 */
 
 /*! \fn QCPDataContainer::iterator QCPDataContainer<DataType>::end() const
@@ -2778,6 +2840,9 @@ protected:
   You can manipulate the data points in-place through the non-const iterators, but great care must
   be taken when manipulating the sort key of a data point, see \ref sort, or the detailed
   description of this class.
+
+  Calling this method discards the cached key and value ranges (see \ref keyRange, \ref
+  valueRange), so prefer \ref constEnd for read-only access.
 */
 
 /*! \fn QCPDataContainer::const_iterator QCPDataContainer<DataType>::at(int index) const
@@ -2805,15 +2870,18 @@ protected:
 template <class DataType>
 QCPDataContainer<DataType>::QCPDataContainer() :
   mAutoSqueeze(true),
+  mCapacity(0),
   mPreallocSize(0),
   mPreallocIteration(0)
 {
+  invalidateRangeCache();
 }
 
 /*!
   Sets whether the container automatically decides when to release memory from its post- and
   preallocation pools when data points are removed. By default this is enabled and for typical
-  applications shouldn't be changed.
+  applications shouldn't be changed. It has no effect while the container has a fixed capacity
+  (\ref setCapacity).
   
   If auto squeeze is disabled, you can manually decide when to release pre-/postallocation with
   \ref squeeze.
@@ -2829,6 +2897,33 @@ void QCPDataContainer<DataType>::setAutoSqueeze(bool enabled)
   }
 }
 
+/*!
+  Limits the number of data points kept in this container to \a capacity. Whenever data is added
+  beyond the capacity, the data points with the smallest sort keys are removed, as with \ref
+  removeBefore. If the container currently holds more data points, the ones with the smallest sort
+  keys are removed right away. Set \a capacity to 0 to keep all data points, which is the default.
+
+  With a capacity, the container allocates memory for twice the capacity and keeps it until the
+  capacity is reset, auto squeeze (\ref setAutoSqueeze) doesn't apply. This makes the container a
+  ring buffer that doesn't allocate memory anymore when data is continuously appended, see the
+  detailed description of this class.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setCapacity(int capacity)
+{
+  mCapacity = qMax(0, capacity);
+  if (mCapacity > 0)
+  {
+    enforceCapacity();
+    if (mData.capacity() < 2*mCapacity)
+    {
+      squeeze(true, false);
+      mData.reserve(2*mCapacity);
+    }
+  } else if (mAutoSqueeze)
+    performAutoSqueeze();
+}
+
 /*! \overload
   
   Replaces the current data in this container with the provided \a data.
@@ -2857,8 +2952,14 @@ void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool already
   mData = data;
   mPreallocSize = 0;
   mPreallocIteration = 0;
+  invalidateRangeCache();
   if (!alreadySorted)
     sort();
+  if (mCapacity > 0)
+  {
+    enforceCapacity();
+    mData.reserve(2*mCapacity);
+  }
 }
 
 /*! \overload
@@ -2874,6 +2975,7 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
     return;
   
   const int n = data.size();
+  makeRoom(n);
   const int oldSize = size();
   
   if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*constBegin(), *(data.constEnd()-1))) // prepend if new data keys are all smaller than or equal to existing ones
@@ -2881,14 +2983,16 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
     if (mPreallocSize < n)
       preallocateGrow(n);
     mPreallocSize -= n;
-    std::copy(data.constBegin(), data.constEnd(), begin());
+    std::copy(data.constBegin(), data.constEnd(), internalBegin());
   } else // don't need to prepend, so append and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), internalEnd()-n);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
-      std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      std::inplace_merge(internalBegin(), internalEnd()-n, internalEnd(), qcpLessThanSortKey<DataType>);
   }
+  expandRangeCache(data.constBegin(), data.constEnd());
+  enforceCapacity();
 }
 
 /*!
@@ -2911,6 +3015,7 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
   }
   
   const int n = data.size();
+  makeRoom(n);
   const int oldSize = size();
   
   if (alreadySorted && oldSize > 0 && !qcpLessThanSortKey<DataType>(*constBegin(), *(data.constEnd()-1))) // prepend if new data is sorted and keys are all smaller than or equal to existing ones
@@ -2918,16 +3023,18 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
     if (mPreallocSize < n)
       preallocateGrow(n);
     mPreallocSize -= n;
-    std::copy(data.constBegin(), data.constEnd(), begin());
+    std::copy(data.constBegin(), data.constEnd(), internalBegin());
   } else // don't need to prepend, so append and then sort and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), internalEnd()-n);
     if (!alreadySorted) // sort appended subrange if it wasn't already sorted
-      std::sort(end()-n, end(), qcpLessThanSortKey<DataType>);
+      std::sort(internalEnd()-n, internalEnd(), qcpLessThanSortKey<DataType>);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
-      std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      std::inplace_merge(internalBegin(), internalEnd()-n, internalEnd(), qcpLessThanSortKey<DataType>);
   }
+  expandRangeCache(data.constBegin(), data.constEnd());
+  enforceCapacity();
 }
 
 /*! \overload
@@ -2939,6 +3046,7 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
 template <class DataType>
 void QCPDataContainer<DataType>::add(const DataType &data)
 {
+  makeRoom(1);
   if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1))) // quickly handle appends if new data key is greater or equal to existing ones
   {
     mData.append(data);
@@ -2947,12 +3055,14 @@ void QCPDataContainer<DataType>::add(const DataType &data)
     if (mPreallocSize < 1)
       preallocateGrow(1);
     --mPreallocSize;
-    *begin() = data;
+    *internalBegin() = data;
   } else // handle inserts, maintaining sorted keys
   {
-    QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(begin(), end(), data, qcpLessThanSortKey<DataType>);
+    QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(internalBegin(), internalEnd(), data, qcpLessThanSortKey<DataType>);
     mData.insert(insertionPoint, data);
   }
+  expandRangeCache(data);
+  enforceCapacity();
 }
 
 /*!
@@ -2963,8 +3073,9 @@ void QCPDataContainer<DataType>::add(const DataType &data)
 template <class DataType>
 void QCPDataContainer<DataType>::removeBefore(double sortKey)
 {
-  QCPDataContainer<DataType>::iterator it = begin();
-  QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator it = internalBegin();
+  QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(internalBegin(), internalEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  shrinkRangeCache(it, itEnd);
   mPreallocSize += int(itEnd-it); // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2978,8 +3089,9 @@ void QCPDataContainer<DataType>::removeBefore(double sortKey)
 template <class DataType>
 void QCPDataContainer<DataType>::removeAfter(double sortKey)
 {
-  QCPDataContainer<DataType>::iterator it = std::upper_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
-  QCPDataContainer<DataType>::iterator itEnd = end();
+  QCPDataContainer<DataType>::iterator it = std::upper_bound(internalBegin(), internalEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator itEnd = internalEnd();
+  shrinkRangeCache(it, itEnd);
   mData.erase(it, itEnd); // typically adds it to the postallocated block
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2998,8 +3110,9 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
   if (sortKeyFrom >= sortKeyTo || isEmpty())
     return;
   
-  QCPDataContainer<DataType>::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
-  QCPDataContainer<DataType>::iterator itEnd = std::upper_bound(it, end(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator it = std::lower_bound(internalBegin(), internalEnd(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator itEnd = std::upper_bound(it, internalEnd(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
+  shrinkRangeCache(it, itEnd);
   mData.erase(it, itEnd);
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -3017,10 +3130,11 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
 template <class DataType>
 void QCPDataContainer<DataType>::remove(double sortKey)
 {
-  QCPDataContainer::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
-  if (it != end() && it->sortKey() == sortKey)
+  QCPDataContainer::iterator it = std::lower_bound(internalBegin(), internalEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  if (it != internalEnd() && it->sortKey() == sortKey)
   {
-    if (it == begin())
+    shrinkRangeCache(it, it+1);
+    if (it == internalBegin())
       ++mPreallocSize; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
     else
       mData.erase(it);
@@ -3040,6 +3154,9 @@ void QCPDataContainer<DataType>::clear()
   mData.clear();
   mPreallocIteration = 0;
   mPreallocSize = 0;
+  if (mCapacity > 0)
+    mData.reserve(2*mCapacity);
+  invalidateRangeCache();
 }
 
 /*!
@@ -3056,7 +3173,7 @@ void QCPDataContainer<DataType>::clear()
 template <class DataType>
 void QCPDataContainer<DataType>::sort()
 {
-  std::sort(begin(), end(), qcpLessThanSortKey<DataType>);
+  std::sort(internalBegin(), internalEnd(), qcpLessThanSortKey<DataType>);
 }
 
 /*!
@@ -3076,7 +3193,7 @@ void QCPDataContainer<DataType>::squeeze(bool preAllocation, bool postAllocation
   {
     if (mPreallocSize > 0)
     {
-      std::copy(begin(), end(), mData.begin());
+      std::copy(internalBegin(), internalEnd(), mData.begin());
       mData.resize(size());
       mPreallocSize = 0;
     }
@@ -3152,6 +3269,9 @@ typename QCPDataContainer<DataType>::const_iterator QCPDataContainer<DataType>::
   
   If the DataType reports that its main key is equal to the sort key (\a sortKeyIsMainKey), as is
   the case for most plottables, this method uses this fact and finds the range very quickly.
+
+  The result is cached per sign domain and kept up to date when data is added or removed, see the
+  detailed description of this class.
   
   \see valueRange
 */
@@ -3163,6 +3283,12 @@ QCPRange QCPDataContainer<DataType>::keyRange(bool &foundRange, QCP::SignDomain
     foundRange = false;
     return QCPRange();
   }
+  RangeCache &cache = mKeyRangeCache[signDomain];
+  if (cache.valid)
+  {
+    foundRange = cache.haveLower && cache.haveUpper;
+    return cache.range;
+  }
   QCPRange range;
   bool haveLower = false;
   bool haveUpper = false;
@@ -3258,6 +3384,10 @@ QCPRange QCPDataContainer<DataType>::keyRange(bool &foundRange, QCP::SignDomain
     }
   }
   
+  cache.range = range;
+  cache.haveLower = haveLower;
+  cache.haveUpper = haveUpper;
+  cache.valid = true;
   foundRange = haveLower && haveUpper;
   return range;
 }
@@ -3272,7 +3402,9 @@ QCPRange QCPDataContainer<DataType>::keyRange(bool &foundRange, QCP::SignDomain
   Inf and -Inf data values are ignored.
 
   If \a inKeyRange has both lower and upper bound set to zero (is equal to <tt>QCPRange()</tt>),
-  all data points are considered, without any restriction on the keys.
+  all data points are considered, without any restriction on the keys. In that case the result is
+  cached per sign domain and kept up to date when data is added or removed, see the detailed
+  description of this class.
 
   Use \a signDomain to control which sign of the value coordinates should be considered. This is
   relevant e.g. for logarithmic plots which can mathematically only display one sign domain at a
@@ -3288,8 +3420,14 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
     foundRange = false;
     return QCPRange();
   }
-  QCPRange range;
   const bool restrictKeyRange = inKeyRange != QCPRange();
+  RangeCache &cache = mValueRangeCache[signDomain];
+  if (!restrictKeyRange && cache.valid)
+  {
+    foundRange = cache.haveLower && cache.haveUpper;
+    return cache.range;
+  }
+  QCPRange range;
   bool haveLower = false;
   bool haveUpper = false;
   QCPRange current;
@@ -3356,6 +3494,13 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
     }
   }
   
+  if (!restrictKeyRange)
+  {
+    cache.range = range;
+    cache.haveLower = haveLower;
+    cache.haveUpper = haveUpper;
+    cache.valid = true;
+  }
   foundRange = haveLower && haveUpper;
   return range;
 }
@@ -3419,6 +3564,8 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
 template <class DataType>
 void QCPDataContainer<DataType>::performAutoSqueeze()
 {
+  if (mCapacity > 0) // the buffer of a fixed capacity is kept, see setCapacity
+    return;
   const int totalAlloc = mData.capacity();
   const int postAllocSize = totalAlloc-mData.size();
   const int usedSize = size();
@@ -3438,6 +3585,140 @@ void QCPDataContainer<DataType>::performAutoSqueeze()
     squeeze(shrinkPreAllocation, shrinkPostAllocation);
 }
 
+/*! \internal
+  
+  Makes room for \a n data points behind the last data point without reallocating, if the
+  container has a fixed capacity (\ref setCapacity): When the buffer is used up to its end, the data
+  points are moved to its start, into the space left by the points that were removed at the front.
+  Since the container holds at most the capacity and the buffer has twice the capacity, this
+  happens at most every capacity added points.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::makeRoom(int n)
+{
+  if (mCapacity > 0 && mPreallocSize > 0 && mData.size()+n > mData.capacity())
+    squeeze(true, false);
+}
+
+/*! \internal
+  
+  Removes the data points with the smallest sort keys that exceed the capacity, if the container
+  has one (\ref setCapacity). Like \ref removeBefore, they are only added to the preallocated block.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::enforceCapacity()
+{
+  const int excess = size()-mCapacity;
+  if (mCapacity > 0 && excess > 0)
+  {
+    shrinkRangeCache(constBegin(), constBegin()+excess);
+    mPreallocSize += excess;
+  }
+}
+
+/*! \internal
+  
+  Discards the cached results of \ref keyRange and \ref valueRange for all sign domains, so they
+  are determined from all data points on their next call.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::invalidateRangeCache()
+{
+  for (int i=0; i<3; ++i)
+  {
+    mKeyRangeCache[i].valid = false;
+    mValueRangeCache[i].valid = false;
+  }
+}
+
+/*! \internal
+  
+  Expands the valid cached key and value ranges such that they include the newly added data point
+  \a data. The same points are ignored as in \ref keyRange and \ref valueRange.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::expandRangeCache(const DataType &data)
+{
+  for (int i=0; i<3; ++i)
+  {
+    if (mKeyRangeCache[i].valid && !qIsNaN(data.mainValue()))
+      expandCachedRange(mKeyRangeCache[i], data.mainKey(), data.mainKey(), QCP::SignDomain(i), false);
+    if (mValueRangeCache[i].valid)
+    {
+      const QCPRange current = data.valueRange();
+      expandCachedRange(mValueRangeCache[i], current.lower, current.upper, QCP::SignDomain(i), true);
+    }
+  }
+}
+
+/*! \internal \overload
+  
+  Expands the valid cached key and value ranges such that they include the newly added data points
+  between \a begin and \a end.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::expandRangeCache(const_iterator begin, const_iterator end)
+{
+  bool anyValid = false;
+  for (int i=0; i<3; ++i)
+    anyValid |= mKeyRangeCache[i].valid || mValueRangeCache[i].valid;
+  if (!anyValid)
+    return;
+  for (const_iterator it=begin; it!=end; ++it)
+    expandRangeCache(*it);
+}
+
+/*! \internal
+  
+  Must be called before the data points between \a begin and \a end are removed. Only the
+  removed points are inspected: A cached range stays valid unless one of them lies on its lower or
+  upper bound, since only then the range of the remaining points may be smaller.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::shrinkRangeCache(const_iterator begin, const_iterator end)
+{
+  for (int i=0; i<3; ++i)
+  {
+    RangeCache &keyCache = mKeyRangeCache[i];
+    RangeCache &valueCache = mValueRangeCache[i];
+    for (const_iterator it=begin; it!=end && (keyCache.valid || valueCache.valid); ++it)
+    {
+      if (keyCache.valid && !qIsNaN(it->mainValue()) && (it->mainKey() <= keyCache.range.lower || it->mainKey() >= keyCache.range.upper))
+        keyCache.valid = false;
+      if (valueCache.valid)
+      {
+        const QCPRange current = it->valueRange();
+        if (current.lower <= valueCache.range.lower || current.upper >= valueCache.range.upper)
+          valueCache.valid = false;
+      }
+    }
+  }
+}
+
+/*! \internal
+  
+  Expands the range of \a cache to include \a lower and \a upper, if they are in the sign domain
+  \a signDomain and not NaN. If \a finiteOnly is true, infinite values are ignored, too.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::expandCachedRange(RangeCache &cache, double lower, double upper, QCP::SignDomain signDomain, bool finiteOnly)
+{
+  const bool lowerUsable = !qIsNaN(lower) && (!finiteOnly || std::isfinite(lower)) &&
+      (signDomain == QCP::sdBoth || (signDomain == QCP::sdNegative ? lower < 0 : lower > 0));
+  const bool upperUsable = !qIsNaN(upper) && (!finiteOnly || std::isfinite(upper)) &&
+      (signDomain == QCP::sdBoth || (signDomain == QCP::sdNegative ? upper < 0 : upper > 0));
+  if (lowerUsable && (lower < cache.range.lower || !cache.haveLower))
+  {
+    cache.range.lower = lower;
+    cache.haveLower = true;
+  }
+  if (upperUsable && (upper > cache.range.upper || !cache.haveUpper))
+  {
+    cache.range.upper = upper;
+    cache.haveUpper = true;
+  }
+}
+
 
 /* end of 'src/datacontainer.h' */
 
@@ -3846,6 +4127,8 @@ public:
   QCP::SelectionRectMode selectionRectMode() const { return mSelectionRectMode; }
   QCPSelectionRect *selectionRect() const { return mSelectionRect; }
   bool openGl() const { return mOpenGl; }
+  bool streamingMode() const { return mStreamingMode; }
+  QCPLayer *streamingLayer() const { return mStreamingLayer.data(); }
   
   // setters:
   void setViewport(const QRect &rect);
@@ -3870,6 +4153,7 @@ public:
   void setSelectionRectMode(QCP::SelectionRectMode mode);
   void setSelectionRect(QCPSelectionRect *selectionRect);
   void setOpenGl(bool enabled, int multisampling=16);
+  void setStreamingMode(bool enabled);
   
   // non-property methods:
   // plottable interface:
@@ -3939,6 +4223,7 @@ public:
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpRefreshHint);
+  Q_SLOT void replotData(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpRefreshHint);
   double replotTime(bool average=false) const;
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
@@ -3990,6 +4275,7 @@ protected:
   QCP::SelectionRectMode mSelectionRectMode;
   QCPSelectionRect *mSelectionRect;
   bool mOpenGl;
+  bool mStreamingMode;
   
   // non-property members:
   QList<QSharedPointer<QCPAbstractPaintBuffer> > mPaintBuffers;
@@ -4001,7 +4287,11 @@ protected:
   QVariant mMouseSignalLayerableDetails;
   bool mReplotting;
   bool mReplotQueued;
+  bool mDataReplotQueued;
   double mReplotTime, mReplotTimeAverage;
+  QPointer<QCPLayer> mStreamingLayer;
+  QRect mStreamingViewport;
+  QVector<QCPRange> mStreamingRanges;
   int mOpenGlMultisamples;
   QCP::AntialiasedElements mOpenGlAntialiasedElementsBackup;
   bool mOpenGlCacheLabelsBackup;
@@ -4042,6 +4332,8 @@ protected:
   void setupPaintBuffers();
   QCPAbstractPaintBuffer *createPaintBuffer();
   bool hasInvalidatedPaintBuffers();
+  QVector<QCPRange> axisRanges() const;
+  void updateReplotTime(double milliseconds);
   bool setupOpenGl();
   void freeOpenGl();
   
@@ -5491,6 +5783,151 @@ Q_DECLARE_TYPEINFO(QCPGraphData, Q_PRIMITIVE_TYPE);
 */
 typedef QCPDataContainer<QCPGraphData> QCPGraphDataContainer;
 
+class QCP_LIB_DECL QCPGraphLodPyramid
+{
+public:
+  /*!
+    Summary of a run of consecutive data points. Values that are NaN are not part of \a minValue
+    and \a maxValue, they only set \a hasNan.
+  */
+  struct Bucket
+  {
+    double firstKey, lastKey;
+    double firstValue, lastValue;
+    double minValue, maxValue;
+    int count;
+    bool hasNan;
+  };
+  
+  QCPGraphLodPyramid();
+  
+  // getters:
+  int levelCount() const { return int(mLevels.size()); }
+  int bucketSize(int level) const { return BaseBucketSize << (2*level); }
+  
+  // non-virtual methods:
+  void clear();
+  void sync(const QCPGraphDataContainer &data);
+  int levelForPointsPerPixel(double pointsPerPixel) const;
+  const Bucket &bucket(int level, qint64 absoluteIndex) const { return mLevels.at(level)[size_t(absoluteIndex-mFirstBucket.at(level))]; }
+  qint64 absoluteIndex(int containerIndex) const { return mAbsoluteBegin+containerIndex; }
+  
+  static Bucket pointBucket(const QCPGraphData &point);
+  static void mergeBucket(Bucket &target, const Bucket &source);
+  
+  static const int BaseBucketSize = 16;
+  static const int MaxLevels = 10;
+  
+protected:
+  QVector<std::deque<Bucket> > mLevels;
+  QVector<qint64> mFirstBucket; // absolute bucket index of the front bucket of each level
+  qint64 mAbsoluteBegin, mAbsoluteEnd; // absolute point indices of the container's begin and end
+  double mFirstKey, mLastKey;
+  
+  // non-virtual methods:
+  void rebuild(const QCPGraphDataContainer &data);
+  void dropBefore(qint64 absoluteIndex);
+  void append(QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end);
+  void updateParents(qint64 firstChild, qint64 lastChild);
+};
+
+
+class QCP_LIB_DECL QCPRasterCanvas
+{
+public:
+  QCPRasterCanvas();
+  
+  bool begin(const QRect &rect, double devicePixelRatio, const QPointF &offset);
+  void drawPolyline(const QVector<QPointF> &points, const QColor &color, double width, bool antialiased);
+  void drawStamps(const QVector<QPointF> &points, const QImage &stamp);
+  void end(QCPPainter *painter);
+  
+protected:
+  QImage mImage;
+  QRect mRect;
+  QPointF mOffset;
+  double mDevicePixelRatio;
+  quint32 *mBits;
+  int mStride;
+  int mDirtyLeft, mDirtyTop, mDirtyRight, mDirtyBottom;
+  
+  void clearDirty();
+  void markDirty(int left, int top, int right, int bottom);
+  void blendPixel(int x, int y, quint32 color, int coverage);
+  void drawSegment(double x0, double y0, double x1, double y1, quint32 color, int thickness);
+  void drawSegmentAntialiased(double x0, double y0, double x1, double y1, quint32 color);
+  bool clipSegment(double &x0, double &y0, double &x1, double &y1, double margin) const;
+  QPointF toImage(const QPointF &point) const;
+};
+
+
+class QCP_LIB_DECL QCPGraphColumns
+{
+public:
+  QCPGraphColumns();
+  
+  // getters:
+  int size() const { return mValues.size()-mBegin; }
+  bool isEmpty() const { return size() == 0; }
+  bool uniformKeys() const { return mUniformKeys; }
+  double keyStep() const { return mKeyStep; }
+  double keyTolerance() const { return mKeyTolerance; }
+  quint64 revision() const { return mRevision; }
+  double keyAt(int index) const { return mUniformKeys ? mKeyStart+(mBegin+index)*mKeyStep : mKeys.at(mBegin+index); }
+  double valueAt(int index) const { return mValues.at(mBegin+index); }
+  
+  // setters:
+  void setUniformKeys(double start, double step);
+  void setKeyStep(double step);
+  void setKeyTolerance(double fraction);
+  
+  // non-virtual methods:
+  void add(double key, double value);
+  void add(const QVector<QCPGraphData> &data);
+  void add(const QCPGraphDataContainer &data);
+  void addValues(const QVector<double> &values);
+  void removeBefore(double key);
+  void clear();
+  int findBegin(double key, bool expandedRange=true) const;
+  int findEnd(double key, bool expandedRange=true) const;
+  QCPRange keyRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth) const;
+  QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const;
+  QVector<QCPGraphData> toGraphData(int begin, int end) const;
+  QVector<QCPGraphData> toGraphData(const QCPRange &keyRange, int bins) const;
+  
+protected:
+  QVector<double> mKeys; // empty while the keys are uniform
+  QVector<double> mValues;
+  int mBegin; // number of removed points at the front of mValues and mKeys
+  bool mUniformKeys;
+  double mKeyStart, mKeyStep; // key of mValues.first() and distance of uniform keys, the step is 0 while unknown
+  double mFixedKeyStep; // step set with setKeyStep, kept by clear, 0 if the first two points define it
+  double mKeyTolerance; // largest deviation from the grid that is still uniform, as a fraction of the step
+  quint64 mRevision;
+  mutable QCPRange mValueRange; // cached result of valueRange over all points and sign domains
+  mutable bool mValueRangeFound, mValueRangeValid;
+  // min/max pyramid over mValues, bucket b of level l holds the complete run of BaseBucketSize*4^l values from index b*BaseBucketSize*4^l:
+  struct Extremes
+  {
+    int minIndex, maxIndex, nanIndex; // indices into mValues, -1 if there is none
+  };
+  mutable QVector<QVector<Extremes> > mLevels;
+  static const int BaseBucketSize = 16;
+  
+  // non-virtual methods:
+  void syncLevels() const;
+  void truncateLevels(int index);
+  Extremes extremes(int begin, int end) const;
+  void addExtremes(Extremes &target, int index) const;
+  void addExtremes(Extremes &target, const Extremes &source) const;
+  void makeKeysExplicit();
+  int lowerBound(double key) const;
+  int upperBound(double key) const;
+  int firstNonNan(int begin, int end) const;
+  int lastNonNan(int begin, int end) const;
+  static void scanValues(const double *begin, const double *end, QCP::SignDomain signDomain, double &lower, double &upper);
+};
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
 {
   Q_OBJECT
@@ -5500,6 +5937,8 @@ class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
   Q_PROPERTY(int scatterSkip READ scatterSkip WRITE setScatterSkip)
   Q_PROPERTY(QCPGraph* channelFillGraph READ channelFillGraph WRITE setChannelFillGraph)
   Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
+  Q_PROPERTY(bool levelOfDetail READ levelOfDetail WRITE setLevelOfDetail)
+  Q_PROPERTY(bool rasterRendering READ rasterRendering WRITE setRasterRendering)
   /// \endcond
 public:
   /*!
@@ -5527,6 +5966,9 @@ public:
   int scatterSkip() const { return mScatterSkip; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph.data(); }
   bool adaptiveSampling() const { return mAdaptiveSampling; }
+  bool levelOfDetail() const { return mLevelOfDetail; }
+  bool rasterRendering() const { return mRasterRendering; }
+  QSharedPointer<QCPGraphColumns> columns() const { return mColumns; }
   
   // setters:
   void setData(QSharedPointer<QCPGraphDataContainer> data);
@@ -5536,6 +5978,9 @@ public:
   void setScatterSkip(int skip);
   void setChannelFillGraph(QCPGraph *targetGraph);
   void setAdaptiveSampling(bool enabled);
+  void setLevelOfDetail(bool enabled);
+  void setRasterRendering(bool enabled);
+  void setColumns(QSharedPointer<QCPGraphColumns> columns);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
@@ -5553,6 +5998,17 @@ protected:
   int mScatterSkip;
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
+  bool mLevelOfDetail;
+  bool mRasterRendering;
+  QSharedPointer<QCPGraphColumns> mColumns;
+  
+  // non-property members:
+  mutable QCPGraphLodPyramid mLodPyramid;
+  mutable QCPRasterCanvas mRasterCanvas;
+  QCPRange mColumnsKeyRange; // key range, bins and revision the data container was filled from mColumns with
+  int mColumnsBins;
+  quint64 mColumnsRevision;
+  bool mColumnsViewValid;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -5568,6 +6024,11 @@ protected:
   virtual void getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const;
   
   // non-virtual methods:
+  bool beginRaster(QCPPainter *painter) const;
+  bool drawRasterPolyline(QCPPainter *painter, const QVector<QPointF> &lines) const;
+  bool drawRasterScatters(QCPPainter *painter, const QVector<QPointF> &scatters, const QCPScatterStyle &style) const;
+  void updateColumnsView();
+  void getLodLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end, int level) const;
   void getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
   void getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
@@ -0,0 +1,142 @@
+#include "renderscheduler.h"
+#include "qcustomplot.h"
+
+#include <QScreen>
+
+RenderScheduler::RenderScheduler(QCustomPlot *plot, QObject *parent)
+    : QObject(parent)
+    , m_plot(plot)
+{
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer, &QTimer::timeout, this, &RenderScheduler::onFrameTick);
+    updateInterval();
+}
+
+void RenderScheduler::setFrameRate(int hz)
+{
+    m_frameRate = qBound(1, hz, 240);
+    updateInterval();
+}
+
+int RenderScheduler::frameRate() const
+{
+    return m_frameRate;
+}
+
+void RenderScheduler::setFrameMode(FrameMode mode)
+{
+    m_frameMode = mode;
+    updateInterval();
+}
+
+RenderScheduler::FrameMode RenderScheduler::frameMode() const
+{
+    return m_frameMode;
+}
+
+void RenderScheduler::start()
+{
+    updateInterval();
+    m_frameTimer.start();
+    m_sinceTick.start();
+}
+
+void RenderScheduler::stop()
+{
+    m_frameTimer.stop();
+}
+
+bool RenderScheduler::isActive() const
+{
+    return m_frameTimer.isActive();
+}
+
+void RenderScheduler::requestReplot(int updates)
+{
+    m_pendingUpdates += qMax(updates, 1);
+}
+
+void RenderScheduler::updateInterval()
+{
+    double hz = m_frameRate;
+
+    // Follow the refresh rate of the screen the plot is shown on
+    if(m_frameMode == VSync && m_plot->screen())
+    {
+        hz = m_plot->screen()->refreshRate();
+        if(hz <= 0)
+        {
+            hz = 60;
+        }
+    }
+
+    m_frameTimer.setInterval(qMax(1, qRound(1000.0/hz)));
+}
+
+void RenderScheduler::onFrameTick()
+{
+    // QTimer drops the ticks that fall due while the event loop is busy, e.g. with a long
+    // replot. Every whole interval beyond the first since the last tick is a skipped frame
+    const int interval = m_frameTimer.interval();
+    const qint64 elapsed = m_sinceTick.restart();
+    if(elapsed >= 2*interval)
+    {
+        m_framesSkipped += quint64(elapsed/interval-1);
+    }
+
+    // Give the owner the chance to hand over new data
+    emit frameTick();
+
+    if(m_pendingUpdates == 0)
+    {
+        m_framesIdle++;
+        return;
+    }
+
+    m_updatesCoalesced += m_pendingUpdates-1;
+    m_pendingUpdates = 0;
+
+    // Only the plottables are redrawn unless the axis ranges moved
+    m_plot->replotData(QCustomPlot::rpQueuedReplot);
+    m_framesRendered++;
+
+    // The last replot took longer than a frame, so the frame rate can not be held
+    if(m_plot->replotTime() > m_frameTimer.interval())
+    {
+        m_framesOverBudget++;
+    }
+}
+
+quint64 RenderScheduler::framesRendered() const
+{
+    return m_framesRendered;
+}
+
+quint64 RenderScheduler::framesIdle() const
+{
+    return m_framesIdle;
+}
+
+quint64 RenderScheduler::framesSkipped() const
+{
+    return m_framesSkipped;
+}
+
+quint64 RenderScheduler::framesOverBudget() const
+{
+    return m_framesOverBudget;
+}
+
+quint64 RenderScheduler::updatesCoalesced() const
+{
+    return m_updatesCoalesced;
+}
+
+void RenderScheduler::resetStatistics()
+{
+    m_framesRendered = 0;
+    m_framesIdle = 0;
+    m_framesSkipped = 0;
+    m_framesOverBudget = 0;
+    m_updatesCoalesced = 0;
+}
@@ -0,0 +1,67 @@
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+class QCustomPlot;
+
+// Paces the replots of a QCustomPlot to a fixed frame rate.
+// Every frame frameTick() is emitted so the owner can move new data into the
+// graphs and call requestReplot(). All requests made between two frames are
+// coalesced into a single queued replot.
+class RenderScheduler: public QObject
+{
+    Q_OBJECT
+
+public:
+    enum FrameMode { FixedRate, VSync };
+
+    RenderScheduler(QCustomPlot *plot, QObject *parent = nullptr);
+
+    void setFrameRate(int hz);
+    int frameRate() const;
+    void setFrameMode(FrameMode mode);
+    FrameMode frameMode() const;
+
+    void start();
+    void stop();
+    bool isActive() const;
+
+    // Mark the plot as dirty, updates is the number of data updates behind the request
+    void requestReplot(int updates = 1);
+
+    // Statistics. Idle frames had no new data, skipped frames are the frame slots
+    // that passed without a tick because the previous frame took too long.
+    quint64 framesRendered() const;
+    quint64 framesIdle() const;
+    quint64 framesSkipped() const;
+    quint64 framesOverBudget() const;
+    quint64 updatesCoalesced() const;
+    void resetStatistics();
+
+signals:
+    void frameTick();
+
+private slots:
+    void onFrameTick();
+
+private:
+    void updateInterval();
+
+    QCustomPlot *m_plot;
+    QTimer m_frameTimer;
+    FrameMode m_frameMode = FixedRate;
+    int m_frameRate = 30;
+    int m_pendingUpdates = 0;
+    QElapsedTimer m_sinceTick;
+
+    quint64 m_framesRendered = 0;
+    quint64 m_framesIdle = 0;
+    quint64 m_framesSkipped = 0;
+    quint64 m_framesOverBudget = 0;
+    quint64 m_updatesCoalesced = 0;
+};
+
+#endif // RENDERSCHEDULER_H
@@ -0,0 +1,186 @@
+#include "replaysource.h"
+
+#include <algorithm>
+#include <limits>
+
+ReplaySource::ReplaySource(QObject *parent)
+    : QObject(parent)
+    , m_stepTimer(this)
+{
+    // A child of the source, so it follows it to the acquisition thread
+    m_stepTimer.setTimerType(Qt::PreciseTimer);
+    m_stepTimer.setInterval(StepInterval);
+    connect(&m_stepTimer, &QTimer::timeout, this, &ReplaySource::replayStep);
+}
+
+bool ReplaySource::open(const QString &filePath)
+{
+    if (!m_file.open(filePath)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_filePath = filePath;
+
+    m_rings.clear();
+    m_startKey = std::numeric_limits<double>::max();
+    m_endKey = std::numeric_limits<double>::lowest();
+    for (int i = 0; i < m_file.sourceCount(); i++) {
+        m_rings.push_back(std::make_unique<SampleRing<RxSample>>(RingCapacity));
+        if (m_file.chunkCount(i) > 0) {
+            m_startKey = qMin(m_startKey, m_file.firstKey(i));
+            m_endKey = qMax(m_endKey, m_file.lastKey(i));
+        }
+    }
+    if (m_startKey > m_endKey)
+        m_startKey = m_endKey = 0;
+
+    m_cursors.assign(m_rings.size(), Cursor());
+    m_position = m_startKey;
+    return true;
+}
+
+QString ReplaySource::errorString() const
+{
+    return m_error;
+}
+
+QString ReplaySource::fileName() const
+{
+    return m_filePath;
+}
+
+int ReplaySource::sourceCount() const
+{
+    return int(m_rings.size());
+}
+
+QString ReplaySource::sourceName(int source) const
+{
+    return m_file.sourceName(source);
+}
+
+SampleRing<RxSample> *ReplaySource::sampleRing(int source)
+{
+    if (source < 0 || source >= int(m_rings.size()))
+        return nullptr;
+    return m_rings[size_t(source)].get();
+}
+
+double ReplaySource::startKey() const
+{
+    return m_startKey;
+}
+
+double ReplaySource::endKey() const
+{
+    return m_endKey;
+}
+
+double ReplaySource::position() const
+{
+    return m_position;
+}
+
+void ReplaySource::setSpeed(double speed)
+{
+    m_speed = qMax(speed, 0.0);
+}
+
+double ReplaySource::speed() const
+{
+    return m_speed;
+}
+
+bool ReplaySource::isRunning() const
+{
+    return m_running;
+}
+
+quint64 ReplaySource::samplesReplayed() const
+{
+    return m_samplesReplayed;
+}
+
+void ReplaySource::start()
+{
+    if (!m_file.isOpen())
+        return;
+
+    m_cursors.assign(m_rings.size(), Cursor());
+    m_samplesReplayed = 0;
+    m_position = m_startKey;
+    m_clockStartKey = m_startKey;
+    m_appliedSpeed = m_speed;
+    m_clock.start();
+
+    m_running = true;
+    m_stepTimer.start();
+    emit consoleOutput(QString("Replaying %1, %2 s").arg(m_filePath).arg(m_endKey - m_startKey, 0, 'f', 1));
+}
+
+void ReplaySource::stop()
+{
+    m_stepTimer.stop();
+    m_running = false;
+}
+
+void ReplaySource::replayStep()
+{
+    // Continue from the current position when the speed was changed
+    const double speed = m_speed;
+    if (speed != m_appliedSpeed) {
+        m_clockStartKey = m_position;
+        m_clock.restart();
+        m_appliedSpeed = speed;
+    }
+
+    const bool unlimited = speed <= 0;
+    const double target = unlimited ? std::numeric_limits<double>::max()
+                                    : m_clockStartKey + m_clock.nsecsElapsed()*1e-9*speed;
+    double reached = m_position;
+    bool done = true;
+
+    for (size_t s = 0; s < m_rings.size(); s++) {
+        SampleRing<RxSample> *ring = m_rings[s].get();
+        Cursor &cursor = m_cursors[s];
+        const int chunkCount = m_file.chunkCount(int(s));
+
+        while (cursor.chunk < chunkCount) {
+            const CaptureFile::Chunk chunk = m_file.chunk(int(s), cursor.chunk);
+            if (!chunk.header) {
+                cursor.chunk = chunkCount;
+                break;
+            }
+
+            // Everything due until now, as far as the ring has room
+            const RxSample *begin = chunk.samples + cursor.sample;
+            const RxSample *end = chunk.samples + chunk.sampleCount;
+            const RxSample *due = unlimited ? end : std::upper_bound(begin, end, target,
+                                                                     [](double k, const RxSample &x) { return k < x.key; });
+            const int room = ring->capacity() - ring->size();
+            const int n = qMin(int(due - begin), room);
+            if (n > 0) {
+                ring->push(begin, n);
+                m_samplesReplayed += quint64(n);
+                reached = qMax(reached, begin[n - 1].key);
+                cursor.sample += n;
+            }
+
+            if (cursor.sample < chunk.sampleCount)
+                break;
+            cursor.chunk++;
+            cursor.sample = 0;
+        }
+
+        if (cursor.chunk < chunkCount)
+            done = false;
+    }
+
+    m_position = unlimited ? reached : qMin(qMax(target, reached), m_endKey);
+
+    if (done) {
+        stop();
+        emit consoleOutput(QString("Replay finished, %1 samples").arg(m_samplesReplayed.load()));
+        emit finished();
+    }
+}
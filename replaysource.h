@@ -0,0 +1,89 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "capturefile.h"
+#include "samplering.h"
+
+// Plays a recorded capture back into sample rings, one per recorded source,
+// the same way a Device fills its ring with decoded samples. The plot drains
+// them like any device, so the buffer and replot path can be exercised and
+// profiled without Bluetooth hardware.
+// The samples keep their recorded keys. At speed 1 they are released in real
+// time, at speed N N times faster, at speed 0 as fast as the rings are
+// drained. A full ring holds the replay back, samples are never dropped.
+class ReplaySource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReplaySource(QObject *parent = nullptr);
+
+    // Call before start(), from the thread that created the source
+    bool open(const QString &filePath);
+    QString errorString() const;
+    QString fileName() const;
+
+    int sourceCount() const;
+    QString sourceName(int source) const;
+    SampleRing<RxSample> *sampleRing(int source);
+
+    double startKey() const;
+    double endKey() const;
+    // Key the replay has reached
+    double position() const;
+
+    // Thread safe, takes effect from the current position
+    void setSpeed(double speed);
+    double speed() const;
+
+    bool isRunning() const;
+    quint64 samplesReplayed() const;
+
+    static const int RingCapacity = 65536;
+    static const int StepInterval = 2;
+
+public slots:
+    // Restarts from the beginning of the capture
+    void start();
+    void stop();
+
+signals:
+    void finished();
+    void consoleOutput(QString msg);
+
+private slots:
+    void replayStep();
+
+private:
+    struct Cursor
+    {
+        int chunk = 0;
+        int sample = 0;
+    };
+
+    CaptureFile m_file;
+    QString m_filePath;
+    QString m_error;
+    std::vector<std::unique_ptr<SampleRing<RxSample>>> m_rings;
+    std::vector<Cursor> m_cursors;
+    double m_startKey = 0;
+    double m_endKey = 0;
+
+    QTimer m_stepTimer;
+    QElapsedTimer m_clock;
+    double m_clockStartKey = 0;
+    double m_appliedSpeed = 1;
+
+    std::atomic<double> m_speed{1};
+    std::atomic<double> m_position{0};
+    std::atomic<bool> m_running{false};
+    std::atomic<quint64> m_samplesReplayed{0};
+};
+
+#endif // REPLAYSOURCE_H
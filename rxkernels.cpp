@@ -0,0 +1,337 @@
+#include "rxkernels.h"
+
+#include <QVector>
+#include <chrono>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define RXKERNELS_HAVE_SSE2
+#  include <emmintrin.h>
+#  if defined(__GNUC__) || defined(__clang__)
+#    define RXKERNELS_HAVE_AVX2
+#    include <immintrin.h>
+#  endif
+#endif
+
+namespace
+{
+
+// Portable reference kernel, also used for the tails of the SIMD kernels
+template <typename T>
+void scalarKernel(const uchar *src, int frames, T *x, T *y, T *z)
+{
+    for (int i = 0; i < frames; i++) {
+        const uchar *p = src + 6*i;
+        x[i] = T(qint16((p[0] << 8) | p[1]));
+        y[i] = T(qint16((p[2] << 8) | p[3]));
+        z[i] = T(qint16((p[4] << 8) | p[5]));
+    }
+}
+
+#ifdef RXKERNELS_HAVE_SSE2
+
+// Loads 8 frames (48 bytes) and returns them as six byte-swapped, sign extended
+// int32 vectors: [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3] [x4 y4 z4 x5] ...
+inline void sse2LoadFrames(const uchar *p, __m128i w[6])
+{
+    for (int r = 0; r < 3; r++) {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16*r));
+        __m128i swapped = _mm_or_si128(_mm_slli_epi16(raw, 8), _mm_srli_epi16(raw, 8));
+        w[2*r] = _mm_srai_epi32(_mm_unpacklo_epi16(swapped, swapped), 16);
+        w[2*r+1] = _mm_srai_epi32(_mm_unpackhi_epi16(swapped, swapped), 16);
+    }
+}
+
+void sse2Kernel(const uchar *src, int frames, double *x, double *y, double *z)
+{
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m128i w[6];
+        sse2LoadFrames(src + 6*i, w);
+
+        // Two doubles per vector, every three vectors hold two frames: [x0 y0] [z0 x1] [y1 z1]
+        __m128d d[12];
+        for (int k = 0; k < 6; k++) {
+            d[2*k] = _mm_cvtepi32_pd(w[k]);
+            d[2*k+1] = _mm_cvtepi32_pd(_mm_shuffle_epi32(w[k], _MM_SHUFFLE(3, 2, 3, 2)));
+        }
+        for (int f = 0; f < 4; f++) {
+            const __m128d a = d[3*f], b = d[3*f+1], c = d[3*f+2];
+            _mm_storeu_pd(x + i + 2*f, _mm_shuffle_pd(a, b, 2));
+            _mm_storeu_pd(y + i + 2*f, _mm_shuffle_pd(a, c, 1));
+            _mm_storeu_pd(z + i + 2*f, _mm_shuffle_pd(b, c, 2));
+        }
+    }
+    scalarKernel(src + 6*i, frames - i, x + i, y + i, z + i);
+}
+
+void sse2Kernel(const uchar *src, int frames, float *x, float *y, float *z)
+{
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m128i w[6];
+        sse2LoadFrames(src + 6*i, w);
+
+        // Every three vectors hold four frames: [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3]
+        for (int f = 0; f < 2; f++) {
+            const __m128 a = _mm_cvtepi32_ps(w[3*f]);
+            const __m128 b = _mm_cvtepi32_ps(w[3*f+1]);
+            const __m128 c = _mm_cvtepi32_ps(w[3*f+2]);
+
+            __m128 q = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 2, 3, 0));
+            __m128 u = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+            _mm_storeu_ps(x + i + 4*f, _mm_shuffle_ps(q, u, _MM_SHUFFLE(2, 0, 1, 0)));
+
+            q = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1));
+            u = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+            _mm_storeu_ps(y + i + 4*f, _mm_shuffle_ps(q, u, _MM_SHUFFLE(2, 0, 2, 0)));
+
+            q = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+            u = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+            _mm_storeu_ps(z + i + 4*f, _mm_shuffle_ps(q, u, _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+    }
+    scalarKernel(src + 6*i, frames - i, x + i, y + i, z + i);
+}
+
+#endif // RXKERNELS_HAVE_SSE2
+
+#ifdef RXKERNELS_HAVE_AVX2
+
+// Byte shuffle masks that gather channel c of 8 frames out of the three 16 byte
+// blocks r and swap the bytes to little endian at the same time
+struct GatherMasks
+{
+    alignas(16) qint8 mask[3][3][16];
+
+    GatherMasks()
+    {
+        for (int c = 0; c < 3; c++) {
+            for (int r = 0; r < 3; r++) {
+                for (int j = 0; j < 8; j++) {
+                    const int high = 6*j + 2*c - 16*r;
+                    const int low = high + 1;
+                    mask[c][r][2*j] = (low >= 0 && low < 16) ? qint8(low) : qint8(-128);
+                    mask[c][r][2*j+1] = (high >= 0 && high < 16) ? qint8(high) : qint8(-128);
+                }
+            }
+        }
+    }
+};
+
+const GatherMasks &gatherMasks()
+{
+    static const GatherMasks masks;
+    return masks;
+}
+
+__attribute__((target("avx2")))
+inline void avx2Store(double *out, __m256i values)
+{
+    _mm256_storeu_pd(out, _mm256_cvtepi32_pd(_mm256_castsi256_si128(values)));
+    _mm256_storeu_pd(out + 4, _mm256_cvtepi32_pd(_mm256_extracti128_si256(values, 1)));
+}
+
+__attribute__((target("avx2")))
+inline void avx2Store(float *out, __m256i values)
+{
+    _mm256_storeu_ps(out, _mm256_cvtepi32_ps(values));
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+void avx2Kernel(const uchar *src, int frames, T *x, T *y, T *z)
+{
+    const GatherMasks &masks = gatherMasks();
+    __m128i m[3][3];
+    for (int c = 0; c < 3; c++)
+        for (int r = 0; r < 3; r++)
+            m[c][r] = _mm_load_si128(reinterpret_cast<const __m128i *>(masks.mask[c][r]));
+
+    T *out[3] = { x, y, z };
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const uchar *p = src + 6*i;
+        const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+        const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 32));
+
+        for (int c = 0; c < 3; c++) {
+            __m128i v = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(b0, m[c][0]),
+                                                  _mm_shuffle_epi8(b1, m[c][1])),
+                                     _mm_shuffle_epi8(b2, m[c][2]));
+            avx2Store(out[c] + i, _mm256_cvtepi16_epi32(v));
+        }
+    }
+
+    // The tail runs non-VEX code, avoid the AVX/SSE transition penalty
+    _mm256_zeroupper();
+    scalarKernel(src + 6*i, frames - i, x + i, y + i, z + i);
+}
+
+#endif // RXKERNELS_HAVE_AVX2
+
+template <typename T>
+void dispatch(RxKernels::Kernel kernel, const uchar *src, int frames, T *x, T *y, T *z)
+{
+    if (frames <= 0)
+        return;
+    if (!RxKernels::isSupported(kernel))
+        kernel = RxKernels::Scalar;
+
+    switch (kernel) {
+#ifdef RXKERNELS_HAVE_AVX2
+    case RxKernels::AVX2:
+        avx2Kernel(src, frames, x, y, z);
+        break;
+#endif
+#ifdef RXKERNELS_HAVE_SSE2
+    case RxKernels::SSE2:
+        sse2Kernel(src, frames, x, y, z);
+        break;
+#endif
+    default:
+        scalarKernel(src, frames, x, y, z);
+        break;
+    }
+}
+
+// The loop the RX path used before: compose every value from its two bytes and append it
+void legacyLoop(const uchar *src, int frames, QVector<double> &x, QVector<double> &y, QVector<double> &z)
+{
+    for (int i = 0; i < frames; i++) {
+        int16_t dataPoints[3] = { 0, 0, 0 };
+        for (int k = 0; k < 3; k++) {
+            unsigned char HV = src[6*i + 2*k];
+            unsigned char LV = src[6*i + 2*k + 1];
+            dataPoints[k] |= (HV << 8) | (LV);
+        }
+        x.append(dataPoints[0]);
+        y.append(dataPoints[1]);
+        z.append(dataPoints[2]);
+    }
+}
+
+} // namespace
+
+bool RxKernels::isSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case Scalar:
+        return true;
+    case SSE2:
+#ifdef RXKERNELS_HAVE_SSE2
+        return true;
+#else
+        return false;
+#endif
+    case AVX2:
+#ifdef RXKERNELS_HAVE_AVX2
+    {
+        static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+        return hasAvx2;
+    }
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+RxKernels::Kernel RxKernels::bestKernel()
+{
+    static const Kernel best = isSupported(AVX2) ? AVX2 : (isSupported(SSE2) ? SSE2 : Scalar);
+    return best;
+}
+
+QString RxKernels::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case SSE2:
+        return QStringLiteral("SSE2");
+    case AVX2:
+        return QStringLiteral("AVX2");
+    default:
+        return QStringLiteral("Scalar");
+    }
+}
+
+void RxKernels::int16BEToChannels(const uchar *src, int frames, double *x, double *y, double *z)
+{
+    dispatch(bestKernel(), src, frames, x, y, z);
+}
+
+void RxKernels::int16BEToChannels(const uchar *src, int frames, float *x, float *y, float *z)
+{
+    dispatch(bestKernel(), src, frames, x, y, z);
+}
+
+void RxKernels::int16BEToChannels(Kernel kernel, const uchar *src, int frames, double *x, double *y, double *z)
+{
+    dispatch(kernel, src, frames, x, y, z);
+}
+
+void RxKernels::int16BEToChannels(Kernel kernel, const uchar *src, int frames, float *x, float *y, float *z)
+{
+    dispatch(kernel, src, frames, x, y, z);
+}
+
+QString RxKernels::benchmark(int frames, int iterations)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<uchar> payload(size_t(frames)*6);
+    quint32 seed = 12345;
+    for (uchar &b : payload) {
+        seed = seed*1103515245u + 12345u;
+        b = uchar(seed >> 16);
+    }
+
+    QString report = QString("RX kernel benchmark, %1 frames per packet, %2 packets\n").arg(frames).arg(iterations);
+    double checksum = 0;
+
+    auto addLine = [&](const QString &name, Clock::duration elapsed) {
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        const double perFrame = ns/(double(frames)*iterations);
+        report += QString("%1: %2 ns/frame, %3 Msamples/s\n")
+                      .arg(name, -16)
+                      .arg(perFrame, 0, 'f', 3)
+                      .arg(3e3/perFrame, 0, 'f', 1);
+    };
+
+    QVector<double> lx, ly, lz;
+    Clock::time_point start = Clock::now();
+    for (int it = 0; it < iterations; it++) {
+        lx.clear();
+        ly.clear();
+        lz.clear();
+        legacyLoop(payload.data(), frames, lx, ly, lz);
+        checksum += lx.last() + ly.last() + lz.last();
+    }
+    addLine("legacy loop", Clock::now() - start);
+
+    const size_t n = size_t(frames);
+    std::vector<double> dx(n), dy(n), dz(n);
+    std::vector<float> fx(n), fy(n), fz(n);
+    for (Kernel kernel : { Scalar, SSE2, AVX2 }) {
+        if (!isSupported(kernel))
+            continue;
+
+        start = Clock::now();
+        for (int it = 0; it < iterations; it++) {
+            int16BEToChannels(kernel, payload.data(), frames, dx.data(), dy.data(), dz.data());
+            checksum += dx.back() + dy.back() + dz.back();
+        }
+        addLine(kernelName(kernel) + " double", Clock::now() - start);
+
+        start = Clock::now();
+        for (int it = 0; it < iterations; it++) {
+            int16BEToChannels(kernel, payload.data(), frames, fx.data(), fy.data(), fz.data());
+            checksum += fx.back() + fy.back() + fz.back();
+        }
+        addLine(kernelName(kernel) + " float", Clock::now() - start);
+    }
+
+    report += QString("checksum %1").arg(checksum);
+    return report;
+}
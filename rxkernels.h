@@ -0,0 +1,31 @@
+#ifndef RXKERNELS_H
+#define RXKERNELS_H
+
+#include <QtGlobal>
+#include <QString>
+
+// Conversion kernels for RX payloads of big endian int16 x/y/z frames.
+// Each kernel byte-swaps, widens and deinterleaves a whole payload into
+// separate x, y and z channel arrays. The fastest kernel the CPU supports is
+// picked at runtime (AVX2, SSE2, or the portable scalar loop).
+namespace RxKernels
+{
+    enum Kernel { Scalar, SSE2, AVX2 };
+
+    Kernel bestKernel();
+    bool isSupported(Kernel kernel);
+    QString kernelName(Kernel kernel);
+
+    // src holds frames*6 bytes, every output array must have room for frames values
+    void int16BEToChannels(const uchar *src, int frames, double *x, double *y, double *z);
+    void int16BEToChannels(const uchar *src, int frames, float *x, float *y, float *z);
+
+    // Same as above with an explicit kernel, an unsupported kernel falls back to Scalar
+    void int16BEToChannels(Kernel kernel, const uchar *src, int frames, double *x, double *y, double *z);
+    void int16BEToChannels(Kernel kernel, const uchar *src, int frames, float *x, float *y, float *z);
+
+    // Microbenchmark of the kernels against the original per-byte loop with appends
+    QString benchmark(int frames = 40, int iterations = 200000);
+}
+
+#endif // RXKERNELS_H
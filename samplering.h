@@ -0,0 +1,148 @@
+#ifndef SAMPLERING_H
+#define SAMPLERING_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// One decoded sample as it is handed from the Device to the plot
+struct RxSample
+{
+    double key = 0;
+    double x = 0;
+    double y = 0;
+    double z = 0;
+};
+
+// Pipeline timestamps of one RX packet, seconds on the capture time base
+struct LatencyStamp
+{
+    double arrival = 0;
+    double decoded = 0;
+    double buffered = 0;
+};
+
+// Lock-free single-producer/single-consumer ring buffer.
+// All storage is allocated in the constructor, push() and pop() never allocate.
+// Exactly one thread may call the producer functions (push) and exactly one
+// thread may call the consumer functions (pop, clear). If the ring is full the
+// new items are dropped and counted as overruns.
+template <typename T>
+class SampleRing
+{
+public:
+    explicit SampleRing(int capacity = 4096);
+
+    // Producer side
+    bool push(const T &item);
+    int push(const T *items, int count);
+
+    // Consumer side
+    int pop(T *out, int maxCount);
+    void clear();
+
+    int size() const;
+    int capacity() const;
+    quint64 pushedCount() const;
+    quint64 overrunCount() const;
+    void resetCounters();
+
+private:
+    std::vector<T> m_buffer;
+    size_t m_mask = 0;
+
+    // Keep the producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    alignas(64) std::atomic<quint64> m_pushed{0};
+    std::atomic<quint64> m_overruns{0};
+};
+
+template <typename T>
+SampleRing<T>::SampleRing(int capacity)
+{
+    // Round up to a power of two so the index can be masked instead of divided
+    size_t size = 2;
+    while (size < size_t(qMax(capacity, 2)))
+        size <<= 1;
+    m_buffer.resize(size);
+    m_mask = size - 1;
+}
+
+template <typename T>
+bool SampleRing<T>::push(const T &item)
+{
+    return push(&item, 1) == 1;
+}
+
+template <typename T>
+int SampleRing<T>::push(const T *items, int count)
+{
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+    const size_t free = m_buffer.size() - (head - tail);
+    const size_t n = qMin(size_t(qMax(count, 0)), free);
+
+    for (size_t i = 0; i < n; i++)
+        m_buffer[(head + i) & m_mask] = items[i];
+
+    m_head.store(head + n, std::memory_order_release);
+    m_pushed.fetch_add(n, std::memory_order_relaxed);
+    if (n < size_t(count))
+        m_overruns.fetch_add(size_t(count) - n, std::memory_order_relaxed);
+    return int(n);
+}
+
+template <typename T>
+int SampleRing<T>::pop(T *out, int maxCount)
+{
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+    const size_t n = qMin(size_t(qMax(maxCount, 0)), head - tail);
+
+    for (size_t i = 0; i < n; i++)
+        out[i] = m_buffer[(tail + i) & m_mask];
+
+    m_tail.store(tail + n, std::memory_order_release);
+    return int(n);
+}
+
+template <typename T>
+void SampleRing<T>::clear()
+{
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+template <typename T>
+int SampleRing<T>::size() const
+{
+    return int(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+}
+
+template <typename T>
+int SampleRing<T>::capacity() const
+{
+    return int(m_buffer.size());
+}
+
+template <typename T>
+quint64 SampleRing<T>::pushedCount() const
+{
+    return m_pushed.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+quint64 SampleRing<T>::overrunCount() const
+{
+    return m_overruns.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+void SampleRing<T>::resetCounters()
+{
+    m_pushed.store(0, std::memory_order_relaxed);
+    m_overruns.store(0, std::memory_order_relaxed);
+}
+
+#endif // SAMPLERING_H
@@ -0,0 +1,219 @@
+#include "simulatedperipheral.h"
+
+#include <QStringList>
+#include <cmath>
+
+SimulatedPeripheral::SimulatedPeripheral(const Settings &settings, QObject *parent)
+    : DeviceTransport(parent)
+    , m_settings(settings)
+    , m_tickTimer(this)
+    , m_random(settings.seed)
+{
+    m_settings.notificationRate = qMax(m_settings.notificationRate, 0.001);
+    m_settings.framesPerPacket = qBound(1, m_settings.framesPerPacket, 40);
+    m_settings.dropRate = qBound(0.0, m_settings.dropRate, 1.0);
+    m_settings.amplitude = qBound(0.0, m_settings.amplitude, 32767.0);
+
+    // A child of the transport, so it follows it to the acquisition thread
+    m_tickTimer.setTimerType(Qt::PreciseTimer);
+    m_tickTimer.setInterval(TickInterval);
+    connect(&m_tickTimer, &QTimer::timeout, this, &SimulatedPeripheral::tick);
+}
+
+SimulatedPeripheral::Settings SimulatedPeripheral::parseSettings(const QString &spec, bool *ok)
+{
+    Settings s;
+    bool valid = true;
+    const QStringList parts = spec.split(',', Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        const QString key = part.section('=', 0, 0).trimmed();
+        bool numberOk = false;
+        const double value = part.section('=', 1).trimmed().toDouble(&numberOk);
+        if (!numberOk) {
+            valid = false;
+            continue;
+        }
+
+        if (key == "rate")
+            s.notificationRate = value;
+        else if (key == "frames")
+            s.framesPerPacket = int(value);
+        else if (key == "jitter")
+            s.jitter = value;
+        else if (key == "drop")
+            s.dropRate = value;
+        else if (key == "reconnect")
+            s.reconnectInterval = value;
+        else if (key == "down")
+            s.reconnectDuration = value;
+        else if (key == "freq")
+            s.signalFrequency = value;
+        else if (key == "amplitude")
+            s.amplitude = value;
+        else if (key == "auto")
+            s.autoStart = value != 0;
+        else if (key == "seed")
+            s.seed = quint32(value);
+        else
+            valid = false;
+    }
+    if (ok)
+        *ok = valid;
+    return s;
+}
+
+SimulatedPeripheral::Settings SimulatedPeripheral::settings() const
+{
+    return m_settings;
+}
+
+QString SimulatedPeripheral::description() const
+{
+    return QString("Simulated peripheral, %1 notif/s, %2 frames, %3 ms jitter, %4 % drops")
+            .arg(m_settings.notificationRate)
+            .arg(m_settings.framesPerPacket)
+            .arg(m_settings.jitter)
+            .arg(m_settings.dropRate*100);
+}
+
+bool SimulatedPeripheral::isOpen() const
+{
+    return m_open && !m_linkDown;
+}
+
+quint64 SimulatedPeripheral::packetsSent() const
+{
+    return m_packetsSent;
+}
+
+quint64 SimulatedPeripheral::packetsDropped() const
+{
+    return m_packetsDropped;
+}
+
+quint64 SimulatedPeripheral::reconnects() const
+{
+    return m_reconnects;
+}
+
+void SimulatedPeripheral::open()
+{
+    if (m_open)
+        return;
+
+    m_open = true;
+    m_linkDown = false;
+    m_streaming = m_settings.autoStart;
+    m_clock.start();
+    m_nextNotification = 0;
+    m_nextLinkChange = m_settings.reconnectInterval;
+    m_tickTimer.start();
+
+    emit consoleOutput(description());
+    emit opened();
+}
+
+void SimulatedPeripheral::close()
+{
+    if (!m_open)
+        return;
+
+    m_tickTimer.stop();
+    m_open = false;
+    m_streaming = false;
+    emit closed();
+}
+
+void SimulatedPeripheral::write(const QByteArray &data)
+{
+    // Commands are framed as 0x01 <text> 0x0D
+    QByteArray command = data;
+    if (command.startsWith(char(0x01)))
+        command.remove(0, 1);
+    if (command.endsWith(char(0x0D)))
+        command.chop(1);
+
+    if (command == "Live" || command == "Data") {
+        m_streaming = true;
+        // Do not catch up on the time spent idle
+        m_nextNotification = m_clock.nsecsElapsed()*1e-9;
+    } else if (command == "Stop") {
+        m_streaming = false;
+    }
+}
+
+void SimulatedPeripheral::tick()
+{
+    const double now = m_clock.nsecsElapsed()*1e-9;
+
+    // Periodic link loss
+    if (m_settings.reconnectInterval > 0 && now >= m_nextLinkChange) {
+        m_linkDown = !m_linkDown;
+        if (m_linkDown) {
+            m_nextLinkChange = now + m_settings.reconnectDuration;
+            emit consoleOutput("Simulated link lost");
+            emit closed();
+        } else {
+            m_nextLinkChange = now + m_settings.reconnectInterval;
+            m_nextNotification = now;
+            m_reconnects++;
+            emit consoleOutput("Simulated link restored");
+            emit opened();
+        }
+    }
+
+    if (!m_streaming || m_linkDown)
+        return;
+
+    // Send everything that is due, a stalled thread does not cause an endless burst
+    int sent = 0;
+    while (m_nextNotification <= now && sent < MaxPacketsPerTick) {
+        const QByteArray packet = makePacket();
+        if (std::bernoulli_distribution(m_settings.dropRate)(m_random))
+            m_packetsDropped++;
+        else
+            emit notificationReceived(packet);
+        m_packetsSent++;
+        m_nextNotification += nextInterval();
+        sent++;
+    }
+    if (sent == MaxPacketsPerTick)
+        m_nextNotification = now;
+}
+
+QByteArray SimulatedPeripheral::makePacket()
+{
+    const int frames = m_settings.framesPerPacket;
+    QByteArray packet(1 + 6*frames, Qt::Uninitialized);
+    uchar *p = reinterpret_cast<uchar *>(packet.data());
+
+    // The counter lets the receiver see the dropped notifications
+    *p++ = m_sequence++;
+
+    // Three phase shifted sine waves, one frame per nominal sample period
+    const double sampleRate = m_settings.notificationRate*frames;
+    const double omega = 2*M_PI*m_settings.signalFrequency/sampleRate;
+    for (int i = 0; i < frames; i++, m_frame++) {
+        const double phase = omega*double(m_frame);
+        const qint16 values[3] = {
+            qint16(m_settings.amplitude*std::sin(phase)),
+            qint16(m_settings.amplitude*std::sin(phase + 2*M_PI/3)),
+            qint16(m_settings.amplitude*std::sin(phase + 4*M_PI/3))
+        };
+        for (qint16 v : values) {
+            *p++ = uchar(quint16(v) >> 8);
+            *p++ = uchar(quint16(v) & 0xFF);
+        }
+    }
+    return packet;
+}
+
+double SimulatedPeripheral::nextInterval()
+{
+    const double period = 1.0/m_settings.notificationRate;
+    if (m_settings.jitter <= 0)
+        return period;
+
+    const double jitter = m_settings.jitter*1e-3;
+    return qMax(0.0, period + std::uniform_real_distribution<double>(-jitter, jitter)(m_random));
+}
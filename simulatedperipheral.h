@@ -0,0 +1,82 @@
+#ifndef SIMULATEDPERIPHERAL_H
+#define SIMULATEDPERIPHERAL_H
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <atomic>
+#include <random>
+#include "devicetransport.h"
+
+// Synthetic accelerometer peripheral for load tests without a radio.
+// Streams "int16 BE x/y/z" notifications (a sequence counter byte followed by
+// the sample frames) after a "Live" or "Data" command until "Stop", like the
+// firmware. Rate, packet size and jitter are configurable, notifications can
+// be dropped and the link can go down and come back periodically.
+class SimulatedPeripheral: public DeviceTransport
+{
+    Q_OBJECT
+
+public:
+    struct Settings
+    {
+        double notificationRate = 100;  // notifications per second
+        int framesPerPacket = 1;        // x/y/z frames per notification
+        double jitter = 0;              // +- ms on every notification interval
+        double dropRate = 0;            // probability that a notification is lost
+        double reconnectInterval = 0;   // s between link losses, 0 never
+        double reconnectDuration = 1;   // s the link stays down
+        double signalFrequency = 1;     // Hz of the generated waves
+        double amplitude = 4000;
+        bool autoStart = false;         // stream without waiting for a command
+        quint32 seed = 1;
+    };
+
+    explicit SimulatedPeripheral(const Settings &settings = Settings(), QObject *parent = nullptr);
+
+    // Parses "rate=1000,frames=10,jitter=2,drop=0.01,reconnect=30,down=2,auto=1,seed=5",
+    // missing keys keep their defaults
+    static Settings parseSettings(const QString &spec, bool *ok = nullptr);
+
+    Settings settings() const;
+    QString description() const override;
+    bool isOpen() const override;
+
+    quint64 packetsSent() const;
+    quint64 packetsDropped() const;
+    quint64 reconnects() const;
+
+    // Longest burst of notifications sent in one tick
+    static const int MaxPacketsPerTick = 1000;
+    static const int TickInterval = 1;
+
+public slots:
+    void open() override;
+    void close() override;
+    void write(const QByteArray &data) override;
+
+private slots:
+    void tick();
+
+private:
+    QByteArray makePacket();
+    double nextInterval();
+
+    Settings m_settings;
+    QTimer m_tickTimer;
+    QElapsedTimer m_clock;
+    std::mt19937 m_random;
+
+    bool m_open = false;
+    bool m_streaming = false;
+    bool m_linkDown = false;
+    double m_nextNotification = 0;
+    double m_nextLinkChange = 0;
+    quint8 m_sequence = 0;
+    quint64 m_frame = 0;
+
+    std::atomic<quint64> m_packetsSent{0};
+    std::atomic<quint64> m_packetsDropped{0};
+    std::atomic<quint64> m_reconnects{0};
+};
+
+#endif // SIMULATEDPERIPHERAL_H
@@ -0,0 +1,200 @@
+#include "streamingautoscale.h"
+#include "qcustomplot.h"
+
+#include <cmath>
+
+void SlidingExtremes::setWindow(int values)
+{
+    m_window = qMax(0, values);
+    if (m_window > 0) {
+        m_minimum.expire(m_count-m_window);
+        m_maximum.expire(m_count-m_window);
+    }
+}
+
+int SlidingExtremes::window() const
+{
+    return m_window;
+}
+
+void SlidingExtremes::add(double value)
+{
+    const qint64 index = m_count++;
+    if (std::isfinite(value)) {
+        // Without a window nothing expires, so only the extreme itself is needed
+        m_minimum.push(index, value, m_window == 0);
+        m_maximum.push(index, -value, m_window == 0);
+    }
+    if (m_window > 0) {
+        m_minimum.expire(m_count-m_window);
+        m_maximum.expire(m_count-m_window);
+    }
+}
+
+void SlidingExtremes::clear()
+{
+    m_minimum = Deque();
+    m_maximum = Deque();
+    m_count = 0;
+}
+
+bool SlidingExtremes::isEmpty() const
+{
+    return m_minimum.head == m_minimum.candidates.size();
+}
+
+double SlidingExtremes::minimum() const
+{
+    return m_minimum.candidates.at(m_minimum.head).value;
+}
+
+double SlidingExtremes::maximum() const
+{
+    return -m_maximum.candidates.at(m_maximum.head).value;
+}
+
+void SlidingExtremes::Deque::push(qint64 index, double value, bool frontOnly)
+{
+    // Older candidates that are not smaller can never be the minimum again
+    while (candidates.size() > head && candidates.last().value >= value)
+        candidates.removeLast();
+    candidates.append({index, value});
+    if (frontOnly && candidates.size() > head+1)
+        candidates.resize(head+1);
+}
+
+void SlidingExtremes::Deque::expire(qint64 oldestIndex)
+{
+    while (head < candidates.size() && candidates.at(head).index < oldestIndex)
+        head++;
+
+    // Move the live candidates to the front once the expired ones are the majority,
+    // the capacity stays, so this is amortized O(1) and doesn't allocate
+    if (head > 0 && head*2 >= candidates.size()) {
+        candidates.remove(0, head);
+        head = 0;
+    }
+}
+
+StreamingAutoscale::StreamingAutoscale(QCPAxis *axis, QObject *parent)
+    : QObject(parent)
+    , m_axis(axis)
+{
+}
+
+void StreamingAutoscale::setWindow(int points)
+{
+    points = qMax(0, points);
+    if (points == m_window)
+        return;
+
+    // Only a shorter window can do with the candidates, a longer one needs points
+    // they dropped, and without a window only the extremes were kept
+    const bool shrinks = m_window > 0 && points > 0 && points < m_window;
+    m_window = points;
+    for (auto it = m_extremes.begin(); it != m_extremes.end(); ++it) {
+        if (shrinks)
+            it.value().setWindow(m_window);
+        else
+            reseed(it.key(), it.value());
+    }
+}
+
+int StreamingAutoscale::window() const
+{
+    return m_window;
+}
+
+void StreamingAutoscale::setHysteresis(double fraction)
+{
+    m_hysteresis = qMax(0.0, fraction);
+}
+
+double StreamingAutoscale::hysteresis() const
+{
+    return m_hysteresis;
+}
+
+void StreamingAutoscale::addData(QCPGraph *graph, const QVector<QCPGraphData> &data)
+{
+    auto it = m_extremes.find(graph);
+    if (it == m_extremes.end()) {
+        // The points added so far count as well
+        it = m_extremes.insert(graph, SlidingExtremes());
+        reseed(graph, it.value());
+        connect(graph, &QObject::destroyed, this, [this, graph]() {
+            m_extremes.remove(graph);
+        });
+        return;
+    }
+
+    SlidingExtremes &extremes = it.value();
+    for (const QCPGraphData &point : data)
+        extremes.add(point.value);
+}
+
+void StreamingAutoscale::clear()
+{
+    for (auto it = m_extremes.begin(); it != m_extremes.end(); ++it)
+        it.value().clear();
+}
+
+bool StreamingAutoscale::apply()
+{
+    // Like rescaleAxes(true), only the visible graphs count
+    bool found = false;
+    double lower = 0;
+    double upper = 0;
+    for (auto it = m_extremes.constBegin(); it != m_extremes.constEnd(); ++it) {
+        if (!it.key()->realVisibility() || it.value().isEmpty())
+            continue;
+        lower = found ? qMin(lower, it.value().minimum()) : it.value().minimum();
+        upper = found ? qMax(upper, it.value().maximum()) : it.value().maximum();
+        found = true;
+    }
+    if (!found)
+        return false;
+
+    const QCPRange current = m_axis->range();
+    const bool leftRange = lower < current.lower || upper > current.upper;
+    const double span = upper-lower;
+    QCPRange range;
+    if (span > 0) {
+        const double margin = span*m_hysteresis;
+        // Inside the range the axis only shrinks once the unused part is twice the margin
+        if (!leftRange && current.size() <= span+4*margin)
+            return false;
+        range = QCPRange(lower-margin, upper+margin);
+    } else {
+        // All values equal, keep the size like QCPAxis::rescale
+        if (!leftRange)
+            return false;
+        range = QCPRange(lower-current.size()/2, lower+current.size()/2);
+    }
+
+    if (!QCPRange::validRange(range) || range == current)
+        return false;
+    m_axis->setRange(range);
+    return true;
+}
+
+void StreamingAutoscale::reseed(QCPGraph *graph, SlidingExtremes &extremes) const
+{
+    extremes.clear();
+    extremes.setWindow(m_window);
+
+    // Only the points in the window are needed. Graphs drawing from columns hold just
+    // the drawn points in their data container
+    if (QSharedPointer<QCPGraphColumns> columns = graph->columns()) {
+        const int size = columns->size();
+        for (int i = m_window > 0 ? qMax(0, size-m_window) : 0; i < size; i++)
+            extremes.add(columns->valueAt(i));
+        return;
+    }
+    QSharedPointer<QCPGraphDataContainer> data = graph->data();
+    QCPGraphDataContainer::const_iterator begin = data->constBegin();
+    if (m_window > 0 && data->size() > m_window)
+        begin = data->constEnd()-m_window;
+    for (auto it = begin; it != data->constEnd(); ++it)
+        extremes.add(it->value);
+}
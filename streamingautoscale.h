@@ -0,0 +1,94 @@
+#ifndef STREAMINGAUTOSCALE_H
+#define STREAMINGAUTOSCALE_H
+
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+class QCPAxis;
+class QCPGraph;
+class QCPGraphData;
+
+// Minimum and maximum of the last window() values of a series. Both are kept
+// in monotonic deques: a value is dropped as soon as a newer one is at least
+// as small (large), because it can never become the extreme again. Adding a
+// value is O(1) amortized, the extremes are read in O(1) however long the
+// window is. NaN and infinite values are ignored but still count as samples.
+class SlidingExtremes
+{
+public:
+    // Number of most recent values that count, 0 counts all
+    void setWindow(int values);
+    int window() const;
+
+    void add(double value);
+    void clear();
+
+    bool isEmpty() const;
+    double minimum() const;
+    double maximum() const;
+
+private:
+    // Candidates in the order they were added, ascending values from the head
+    struct Candidate
+    {
+        qint64 index;
+        double value;
+    };
+    struct Deque
+    {
+        QVector<Candidate> candidates;
+        int head = 0;
+
+        void push(qint64 index, double value, bool frontOnly);
+        void expire(qint64 oldestIndex);
+    };
+
+    // The maximum deque holds the negated values
+    Deque m_minimum;
+    Deque m_maximum;
+    qint64 m_count = 0;
+    int m_window = 0;
+};
+
+// Streaming autoscale of a value axis, a replacement for
+// QCustomPlot::rescaleAxes(true) that doesn't look at the graph data again.
+// The owner of the graphs hands every appended point over, the extremes of the
+// last window() points of every graph are tracked by SlidingExtremes, and
+// apply() fits the axis to those of the visible graphs. With hysteresis the
+// axis gets a margin around the data: it grows as soon as a point leaves the
+// range, and shrinks only when the unused part is more than twice the margin,
+// so the range (and with it the axes and grid layers) doesn't change every frame.
+class StreamingAutoscale: public QObject
+{
+    Q_OBJECT
+
+public:
+    StreamingAutoscale(QCPAxis *axis, QObject *parent = nullptr);
+
+    // Number of most recent points per graph that count, 0 counts all.
+    // Changing it reads the points in the window from the graphs once.
+    void setWindow(int points);
+    int window() const;
+    // Margin on both sides as a fraction of the data span
+    void setHysteresis(double fraction);
+    double hysteresis() const;
+
+    // Points just appended to graph, after the graph dropped its oldest points
+    void addData(QCPGraph *graph, const QVector<QCPGraphData> &data);
+    void clear();
+    // Sets the axis range, returns whether it changed
+    bool apply();
+
+    static constexpr double DefaultHysteresis = 0.05;
+
+private:
+    void reseed(QCPGraph *graph, SlidingExtremes &extremes) const;
+
+    QCPAxis *m_axis;
+    QHash<QCPGraph*, SlidingExtremes> m_extremes;
+    int m_window = 0;
+    double m_hysteresis = DefaultHysteresis;
+};
+
+#endif // STREAMINGAUTOSCALE_H